@@ -0,0 +1,93 @@
+/*
+ * BFS throughput, pointer-based Vertex::neighbor vs. CSR of Graph
+ * usage: build/bench_bfs [map files...]
+ */
+#include <lacam.hpp>
+
+#include "bench_utils.hpp"
+
+// before: queue of pointers, Vertex::neighbor
+static int bfs_pointer(const Graph& G, Vertex* s, std::vector<int>& dist)
+{
+  std::fill(dist.begin(), dist.end(), -1);
+  std::queue<Vertex*> Q;
+  Q.push(s);
+  dist[s->id] = 0;
+  int cnt = 0;
+  while (!Q.empty()) {
+    auto n = Q.front();
+    Q.pop();
+    ++cnt;
+    for (auto m : n->neighbor) {
+      if (dist[m->id] != -1) continue;
+      dist[m->id] = dist[n->id] + 1;
+      Q.push(m);
+    }
+  }
+  return cnt;
+}
+
+// after: array queue of vertex-ids, CSR
+static int bfs_csr(const Graph& G, Vertex* s, std::vector<int>& dist,
+                   std::vector<int>& Q)
+{
+  std::fill(dist.begin(), dist.end(), -1);
+  size_t head = 0, tail = 0;
+  Q[tail++] = s->id;
+  dist[s->id] = 0;
+  while (head < tail) {
+    const auto n = Q[head++];
+    for (auto k = G.adj_offsets[n]; k < G.adj_offsets[n + 1]; ++k) {
+      const auto m = G.adj[k];
+      if (dist[m] != -1) continue;
+      dist[m] = dist[n] + 1;
+      Q[tail++] = m;
+    }
+  }
+  return tail;
+}
+
+static void run(const std::string& map_name)
+{
+  const auto G = Graph(map_name);
+  const int K = G.size();
+  if (K == 0) return;
+  auto dist = std::vector<int>(K);
+  auto Q = std::vector<int>(K);
+  auto MT = std::mt19937(0);
+  const int R = std::max(8, 4000000 / K);  // number of BFS runs
+  auto sources = Vertices();
+  for (int r = 0; r < R; ++r) sources.push_back(G.V[MT() % K]);
+
+  long long visited = 0;
+  const auto t_pointer = Deadline();
+  for (auto s : sources) visited += bfs_pointer(G, s, dist);
+  const auto ns_pointer = t_pointer.elapsed_ns();
+
+  long long visited_csr = 0;
+  const auto t_csr = Deadline();
+  for (auto s : sources) visited_csr += bfs_csr(G, s, dist, Q);
+  const auto ns_csr = t_csr.elapsed_ns();
+
+  if (visited != visited_csr) info(0, 0, "mismatch in ", map_name);
+  std::printf("%-28s |V|=%-8d pointer: %7.1f Mvert/s   csr: %7.1f Mvert/s\n",
+              map_name.substr(map_name.find_last_of('/') + 1).c_str(), K,
+              visited / ns_pointer * 1e3, visited / ns_csr * 1e3);
+}
+
+int main(int argc, char* argv[])
+{
+  auto maps = std::vector<std::string>();
+  for (int k = 1; k < argc; ++k) maps.push_back(argv[k]);
+  if (maps.empty()) {
+    maps.push_back("./assets/random-32-32-10.map");
+    for (auto size : {256, 1024}) {
+      auto name = "/tmp/random-" + std::to_string(size) + "-" +
+                  std::to_string(size) + "-10.map";
+      save_random_map(name, size, size, 0.1);
+      maps.push_back(name);
+    }
+  }
+  for (auto& map_name : maps) run(map_name);
+  return 0;
+}
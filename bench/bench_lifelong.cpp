@@ -0,0 +1,51 @@
+/*
+ * per-step latency of lifelong planning, new goals on arrival
+ * usage: build/bench_lifelong [map file] [N] [steps]
+ */
+#include <lacam.hpp>
+
+int main(int argc, char* argv[])
+{
+  const std::string map_name =
+      argc > 1 ? argv[1] : "./assets/random-32-32-10.map";
+  const int N = argc > 2 ? std::stoi(argv[2]) : 200;
+  const int steps = argc > 3 ? std::stoi(argv[3]) : 1000;
+
+  auto MT = std::mt19937(0);
+  const auto ins = Instance(map_name, &MT, N);
+  if (!ins.is_valid(1)) return 1;
+  auto planner = LifelongPlanner(ins, &MT);
+  const auto& G = ins.G;
+
+  std::vector<double> step_us, update_us;
+  int reached = 0;
+  for (int t = 0; t < steps; ++t) {
+    const auto t_step = Deadline();
+    const auto configs = planner.plan(1);
+    step_us.push_back(t_step.elapsed_ns() / 1e3);
+    const auto& C = configs.back();
+
+    const auto t_update = Deadline();
+    for (int i = 0; i < N; ++i) {
+      if (C[i] != planner.ins.goals[i]) continue;
+      ++reached;
+      planner.set_goal(i, G.V[MT() % G.V.size()]);
+    }
+    update_us.push_back(t_update.elapsed_ns() / 1e3);
+  }
+
+  auto report = [](const char* name, std::vector<double>& us) {
+    std::sort(us.begin(), us.end());
+    const auto mean = std::accumulate(us.begin(), us.end(), 0.0) / us.size();
+    std::printf("%-12s mean: %8.1f us  p50: %8.1f us  p99: %8.1f us  "
+                "max: %8.1f us\n",
+                name, mean, us[us.size() / 2], us[us.size() * 99 / 100],
+                us.back());
+  };
+  std::printf("%s\tN=%d\tsteps=%d\tgoals reached: %d\n",
+              map_name.substr(map_name.find_last_of('/') + 1).c_str(), N,
+              steps, reached);
+  report("step", step_us);
+  report("goal update", update_us);
+  return 0;
+}
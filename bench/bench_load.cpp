@@ -0,0 +1,89 @@
+/*
+ * startup time, loading .map and .scen files
+ * usage: build/bench_load [map file] [scen file]
+ */
+#include <lacam.hpp>
+#include <regex>
+#include <sys/stat.h>
+
+static double file_mb(const std::string& filename)
+{
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0) return 0;
+  return st.st_size / 1048576.0;
+}
+
+// synthetic map and scenario, saved to map_name and scen_name
+static void make_instance(const std::string& map_name,
+                          const std::string& scen_name, int size, int num)
+{
+  auto MT = std::mt19937(0);
+  std::ofstream map_file(map_name);
+  map_file << "type octile\nheight " << size << "\nwidth " << size
+           << "\nmap\n";
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      map_file << (get_random_float(&MT) < 0.1 ? '@' : '.');
+    }
+    map_file << "\n";
+  }
+  std::ofstream scen_file(scen_name);
+  scen_file << "version 1\n";
+  for (int k = 0; k < num; ++k) {
+    scen_file << k / 10 << "\tbench.map\t" << size << "\t" << size;
+    for (int j = 0; j < 4; ++j) scen_file << "\t" << MT() % size;
+    scen_file << "\t0\n";
+  }
+}
+
+// reference: previous loader of scenario lines with std::regex
+static int load_scen_regex(const std::string& scen_name)
+{
+  static const std::regex r_instance =
+      std::regex(R"(\d+\t.+\.map\t\d+\t\d+\t(\d+)\t(\d+)\t(\d+)\t(\d+)\t.+)");
+  std::ifstream file(scen_name);
+  std::string line;
+  std::smatch results;
+  int cnt = 0;
+  while (getline(file, line)) {
+    if (std::regex_match(line, results, r_instance)) ++cnt;
+  }
+  return cnt;
+}
+
+int main(int argc, char* argv[])
+{
+  std::string map_name = "/tmp/bench-2000-2000.map";
+  std::string scen_name = "/tmp/bench-2000-2000.scen";
+  if (argc > 2) {
+    map_name = argv[1];
+    scen_name = argv[2];
+  } else {
+    make_instance(map_name, scen_name, 2000, 10000);
+  }
+
+  const auto t_map = Deadline();
+  const auto G = Graph(map_name);
+  const auto ms_map = t_map.elapsed_ns() / 1e6;
+
+  // scenario parsing only, with a tiny map to exclude map loading
+  const auto tiny_map_name = "/tmp/bench-1-1.map";
+  std::ofstream(tiny_map_name) << "type octile\nheight 1\nwidth 1\nmap\n.\n";
+  const auto t_ins = Deadline();
+  const auto ins = Instance(scen_name, tiny_map_name, 1000000);
+  const auto ms_ins = t_ins.elapsed_ns() / 1e6;
+
+  const auto t_regex = Deadline();
+  const auto cnt = load_scen_regex(scen_name);
+  const auto ms_regex = t_regex.elapsed_ns() / 1e6;
+
+  const auto mb_map = file_mb(map_name);
+  const auto mb_scen = file_mb(scen_name);
+  std::printf("map   %8.2f MB %9.2f ms %9.2f ms/MB  (|V|=%d)\n", mb_map,
+              ms_map, ms_map / mb_map, G.size());
+  std::printf("scen  %8.2f MB %9.2f ms %9.2f ms/MB\n", mb_scen, ms_ins,
+              ms_ins / mb_scen);
+  std::printf("scen regex (previous) %9.2f ms %9.2f ms/MB  (lines=%d)\n",
+              ms_regex, ms_regex / mb_scen, cnt);
+  return 0;
+}
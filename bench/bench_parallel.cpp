@@ -0,0 +1,42 @@
+/*
+ * scaling of the shared high-level search over threads
+ * usage: build/bench_parallel [map file] [N] [instances] [time_limit_sec]
+ */
+#include <lacam.hpp>
+#include <thread>
+
+int main(int argc, char* argv[])
+{
+  const std::string map_name =
+      argc > 1 ? argv[1] : "./assets/random-32-32-10.map";
+  const int N = argc > 2 ? std::stoi(argv[2]) : 400;
+  const int num_instances = argc > 3 ? std::stoi(argv[3]) : 5;
+  const int time_limit_sec = argc > 4 ? std::stoi(argv[4]) : 30;
+
+  const auto G = std::make_shared<const Graph>(map_name);
+  auto instances = std::vector<Instance>();
+  for (int k = 0; k < num_instances; ++k) {
+    auto MT = std::mt19937(k);
+    instances.emplace_back(G, &MT, N);
+  }
+  std::printf("%s\tN=%d\tinstances=%d\tcores=%u\n",
+              map_name.substr(map_name.find_last_of('/') + 1).c_str(), N,
+              num_instances, std::thread::hardware_concurrency());
+
+  double base_ms = 0;
+  for (auto threads : {1, 2, 4, 8, 16}) {
+    double total_ms = 0;
+    int solved = 0;
+    for (auto& ins : instances) {
+      const auto deadline = Deadline(time_limit_sec * 1000);
+      const auto solution = solve_parallel(ins, threads, 0, &deadline);
+      total_ms += deadline.elapsed_ns() / 1e6;
+      if (!solution.empty() && is_feasible_solution(ins, solution)) ++solved;
+    }
+    if (threads == 1) base_ms = total_ms;
+    std::printf("threads=%-3d solved=%d/%d  time: %9.1f ms  speedup: %5.2f\n",
+                threads, solved, num_instances, total_ms / num_instances,
+                base_ms / total_ms);
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * latency of single-step PIBT, LifelongPlanner::step
+ * usage: build/bench_pibt [map file] [steps]
+ */
+#include <lacam.hpp>
+
+#include "bench_utils.hpp"
+
+// count heap allocations during steps
+static size_t alloc_cnt = 0;
+void* operator new(size_t size)
+{
+  ++alloc_cnt;
+  if (auto p = std::malloc(size)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static void run(std::shared_ptr<const Graph> G, const int N, const int steps)
+{
+  auto MT = std::mt19937(0);
+  const auto ins = Instance(G, &MT, N);
+  if (!ins.is_valid(1)) return;
+  auto planner = LifelongPlanner(ins, &MT);
+  auto C = ins.starts;
+  auto goals = ins.goals;
+
+  // histogram of latency, bucket k: [2^k, 2^(k+1)) us
+  std::vector<int> hist(24, 0);
+  std::vector<double> us;
+  us.reserve(steps);
+  size_t step_allocs = 0;
+  for (int t = 0; t < steps; ++t) {
+    const auto allocs = alloc_cnt;
+    const auto t_step = Deadline();
+    const auto& C_next = planner.step(C, goals);
+    const auto elapsed_us = t_step.elapsed_ns() / 1e3;
+    step_allocs += alloc_cnt - allocs;
+    us.push_back(elapsed_us);
+    int k = 0;
+    while (k + 1 < (int)hist.size() && (2 << k) <= elapsed_us) ++k;
+    ++hist[k];
+
+    // new goals on arrival, not measured
+    C = C_next;
+    for (int i = 0; i < N; ++i) {
+      if (C[i] != goals[i]) continue;
+      goals[i] = G->V[MT() % G->V.size()];
+      planner.set_goal(i, goals[i]);
+    }
+  }
+
+  std::sort(us.begin(), us.end());
+  std::printf("N=%-6d mean: %8.1f us  p50: %8.1f us  p99: %8.1f us  "
+              "max: %8.1f us  alloc/step (goals unchanged): %zu\n",
+              N, std::accumulate(us.begin(), us.end(), 0.0) / steps,
+              us[steps / 2], us[steps * 99 / 100], us.back(),
+              step_allocs / steps);
+  for (size_t k = 0; k < hist.size(); ++k) {
+    if (hist[k] == 0) continue;
+    std::printf("  [%6d, %6d) us  %6d  %s\n", 1 << k, 2 << k, hist[k],
+                std::string(hist[k] * 50 / steps, '#').c_str());
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::string map_name = argc > 1 ? argv[1] : "";
+  const int steps = argc > 2 ? std::stoi(argv[2]) : 500;
+  if (map_name.empty()) {
+    map_name = "/tmp/random-128-128-10.map";
+    save_random_map(map_name, 128, 128, 0.1);
+  }
+  const auto G = std::make_shared<const Graph>(map_name);
+  std::printf("%s\t|V|=%d\tsteps=%d\n",
+              map_name.substr(map_name.find_last_of('/') + 1).c_str(),
+              G->size(), steps);
+  for (auto N : {100, 300, 1000, 3000, 10000}) {
+    if (N < G->size()) run(G, N, steps);
+  }
+  return 0;
+}
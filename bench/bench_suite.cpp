@@ -0,0 +1,470 @@
+/*
+ * micro and macro benchmarks in the style of Google Benchmark, with CSV
+ * output to be diffed between commits
+ * usage: build/bench_suite [--filter substr] [--csv file] [--min_time sec]
+ *                          [--corpus dir]
+ *   or: make -C build bench, with the stress corpus when generated by
+ *       make -C build stress_corpus
+ *
+ * columns: name, iterations, ns_per_op, items_per_sec, peak_rss_mb, note
+ *   items are benchmark-specific, e.g., search nodes for solve
+ *   peak_rss_mb is the peak during the benchmark when the kernel allows it
+ */
+#include <lacam.hpp>
+
+#include <cstring>
+#include <map>
+
+#include "bench_utils.hpp"
+
+// ---------------------------------------------------------------------------
+// harness
+
+struct State {
+  const std::vector<int> args;
+  size_t max_iterations;
+  size_t iterations;  // completed
+  Time::time_point t_s;
+  double elapsed_ns;
+  double items;
+  std::string note;
+  bool skipped;
+
+  State(const std::vector<int>& _args, size_t _max_iterations)
+      : args(_args),
+        max_iterations(_max_iterations),
+        iterations(0),
+        elapsed_ns(0),
+        items(0),
+        skipped(false)
+  {
+  }
+
+  int range(size_t k) const { return args[k]; }
+  void set_items_processed(double x) { items = x; }
+  void set_note(const std::string& s) { note = s; }
+  void skip(const std::string& reason)  // call before the loop
+  {
+    skipped = true;
+    note = reason;
+  }
+
+  // for (auto _ : state), the timer runs only inside the loop
+  struct Value {
+    ~Value() {}  // non-trivial, to avoid warnings of unused variables
+  };
+  struct Iterator {
+    State* state;
+    bool operator!=(const Iterator&) const
+    {
+      if (state->iterations < state->max_iterations) return true;
+      state->elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              Time::now() - state->t_s)
+                              .count();
+      return false;
+    }
+    void operator++() { ++state->iterations; }
+    Value operator*() const { return Value(); }
+  };
+  Iterator begin()
+  {
+    t_s = Time::now();
+    return Iterator{this};
+  }
+  Iterator end() { return Iterator{this}; }
+};
+
+struct Benchmark {
+  std::string name;
+  std::function<void(State&)> fn;
+  std::vector<std::vector<int> > args_list;
+  size_t fixed_iterations;  // 0 -> calibrated by min_time
+
+  Benchmark* Args(const std::vector<int>& args)
+  {
+    args_list.push_back(args);
+    return this;
+  }
+  Benchmark* Iterations(size_t n)
+  {
+    fixed_iterations = n;
+    return this;
+  }
+};
+
+static std::vector<std::unique_ptr<Benchmark> >& get_benchmarks()
+{
+  static std::vector<std::unique_ptr<Benchmark> > benchmarks;
+  return benchmarks;
+}
+
+static Benchmark* register_benchmark(const char* name,
+                                     std::function<void(State&)> fn)
+{
+  get_benchmarks().emplace_back(new Benchmark{name, fn, {}, 0});
+  return get_benchmarks().back().get();
+}
+
+#define BENCH_CONCAT(a, b) a##b
+#define BENCH_NAME(line) BENCH_CONCAT(benchmark_, line)
+#define BENCHMARK(fn) \
+  static Benchmark* BENCH_NAME(__LINE__) = register_benchmark(#fn, fn)
+
+// peak RSS of the process, reset by /proc/self/clear_refs on Linux
+static bool reset_peak_rss()
+{
+  std::ofstream file("/proc/self/clear_refs");
+  return (file << "5").good();
+}
+
+static size_t read_peak_rss()
+{
+  std::ifstream file("/proc/self/status");
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.rfind("VmHWM:", 0) == 0) return std::stoul(line.substr(6)) << 10;
+  }
+  return get_peak_rss();
+}
+
+// ---------------------------------------------------------------------------
+// fixtures
+
+static std::shared_ptr<const Graph> get_graph(int size, float obstacle_ratio)
+{
+  static std::map<std::pair<int, int>, std::shared_ptr<const Graph> > cache;
+  auto& G = cache[{size, (int)(obstacle_ratio * 100)}];
+  if (G == nullptr) {
+    const auto filename = "/tmp/bench-random-" + std::to_string(size) + "-" +
+                          std::to_string((int)(obstacle_ratio * 100)) + ".map";
+    save_random_map(filename, size, size, obstacle_ratio);
+    G = std::make_shared<const Graph>(filename);
+  }
+  return G;
+}
+
+template <typename T>
+static void do_not_optimize(const T& x)
+{
+  asm volatile("" : : "g"(&x) : "memory");
+}
+
+// ---------------------------------------------------------------------------
+// micro benchmarks
+
+// lookups of a lazy table after BFS, args: map size, agents
+static void BM_dist_table_get(State& state)
+{
+  auto MT = std::mt19937(0);
+  const auto ins = Instance(get_graph(state.range(0), 0.1), &MT,
+                            state.range(1));
+  auto D = DistTable(ins, false);
+  const auto& V = ins.G.V;
+  std::vector<std::pair<int, Vertex*> > queries(1 << 12);
+  for (auto& q : queries) {
+    q = {MT() % ins.N, V[MT() % V.size()]};
+  }
+  for (auto& q : queries) D.get(q.first, q.second);
+  size_t k = 0;
+  int sum = 0;
+  for (auto _ : state) {
+    auto& q = queries[k++ & (queries.size() - 1)];
+    sum += D.get(q.first, q.second);
+  }
+  do_not_optimize(sum);
+  state.set_items_processed(state.iterations);
+}
+BENCHMARK(BM_dist_table_get)->Args({64, 100})->Args({256, 1000});
+
+// full hash of a configuration, args: agents
+static void BM_config_hasher(State& state)
+{
+  auto MT = std::mt19937(0);
+  const auto ins = Instance(get_graph(256, 0.1), &MT, state.range(0));
+  uint64_t h = 0;
+  for (auto _ : state) h ^= ConfigHasher()(ins.starts);
+  do_not_optimize(h);
+  state.set_items_processed(state.iterations * ins.N);
+}
+BENCHMARK(BM_config_hasher)->Args({100})->Args({1000});
+
+// incremental update, one moved agent
+static void BM_config_hasher_update(State& state)
+{
+  auto MT = std::mt19937(0);
+  const auto ins = Instance(get_graph(256, 0.1), &MT, 1000);
+  uint64_t h = 0;
+  int i = 0;
+  for (auto _ : state) {
+    h = ConfigHasher::update(h, i, ins.starts[i], ins.goals[i]);
+    i = (i + 1) % ins.N;
+  }
+  do_not_optimize(h);
+  state.set_items_processed(state.iterations);
+}
+BENCHMARK(BM_config_hasher_update);
+
+// unconstrained PIBT step, i.e., funcPIBT for all agents from a fixed
+// configuration, args: map size, agents
+static void BM_pibt_step(State& state)
+{
+  auto MT = std::mt19937(0);
+  const auto ins = Instance(get_graph(state.range(0), 0.1), &MT,
+                            state.range(1));
+  auto planner = Planner(&ins, nullptr, nullptr);
+  std::vector<int> order(ins.N);
+  std::iota(order.begin(), order.end(), 0);
+  Constraint root;
+  planner.get_new_config(ins.starts, order, &root);  // BFS of lazy table
+  int cnt = 0;
+  for (auto _ : state) cnt += planner.get_new_config(ins.starts, order, &root);
+  state.set_items_processed(state.iterations * ins.N);
+  state.set_note("success=" + std::to_string(cnt == (int)state.iterations));
+}
+BENCHMARK(BM_pibt_step)->Args({64, 100})->Args({256, 1000});
+
+// constrained step, the first half of agents are fixed by constraints
+static void BM_get_new_config(State& state)
+{
+  auto MT = std::mt19937(0);
+  const auto ins = Instance(get_graph(state.range(0), 0.1), &MT,
+                            state.range(1));
+  auto planner = Planner(&ins, nullptr, nullptr);
+  std::vector<int> order(ins.N);
+  std::iota(order.begin(), order.end(), 0);
+  Constraint root;
+  planner.get_new_config(ins.starts, order, &root);
+  Arena arena;
+  auto M = &root;
+  for (size_t k = 0; k < ins.N / 2; ++k) {
+    M = arena.create<Constraint>(M, k, planner.A[k]->v_next);
+  }
+  int cnt = 0;
+  for (auto _ : state) cnt += planner.get_new_config(ins.starts, order, M);
+  state.set_items_processed(state.iterations * ins.N);
+  state.set_note("success=" + std::to_string(cnt == (int)state.iterations));
+}
+BENCHMARK(BM_get_new_config)->Args({64, 100})->Args({256, 1000});
+
+// validation of a long lifelong solution, args: agents, timesteps
+static void BM_is_feasible_solution(State& state)
+{
+  auto MT = std::mt19937(0);
+  auto ins = Instance(get_graph(128, 0.1), &MT, state.range(0));
+  auto planner = LifelongPlanner(ins, &MT);
+  auto configs = planner.plan(state.range(1));
+  configs.insert(configs.begin(), ins.starts);
+  ins.goals = configs.back();
+  const auto solution = Solution(configs);
+  int cnt = 0;
+  for (auto _ : state) cnt += is_feasible_solution(ins, solution);
+  state.set_items_processed(state.iterations * ins.N * solution.size());
+  state.set_note("valid=" + std::to_string(cnt == (int)state.iterations));
+}
+BENCHMARK(BM_is_feasible_solution)->Args({1000, 100});
+
+// delta encoding of a long lifelong solution, args: agents, timesteps
+static void BM_solution_push_back(State& state)
+{
+  auto MT = std::mt19937(0);
+  auto ins = Instance(get_graph(128, 0.1), &MT, state.range(0));
+  auto planner = LifelongPlanner(ins, &MT);
+  const auto configs = planner.plan(state.range(1));
+  size_t memory = 0;
+  for (auto _ : state) {
+    auto solution = Solution();
+    for (auto& C : configs) solution.push_back(C);
+    memory = solution.memory();
+  }
+  state.set_items_processed(state.iterations * ins.N * configs.size());
+  state.set_note("memory=" + std::to_string(memory >> 10) + "KB/" +
+                 std::to_string(ins.N * configs.size() * 4 >> 10) + "KB");
+}
+BENCHMARK(BM_solution_push_back)->Args({1000, 100});
+
+// ---------------------------------------------------------------------------
+// macro benchmarks
+
+// solve random instances with a fixed seed
+// args: map size, obstacle ratio (%), agents, seed
+static void BM_solve(State& state)
+{
+  const auto G = get_graph(state.range(0), state.range(1) / 100.0);
+  auto MT = std::mt19937(state.range(3));
+  const auto ins = Instance(G, &MT, state.range(2));
+  size_t explored = 0;
+  int soc = 0;
+  for (auto _ : state) {
+    const auto deadline = Deadline(60000);
+    auto planner = Planner(&ins, &deadline, &MT);
+    const auto solution = planner.solve();
+    explored += planner.CLOSED->size();
+    soc = get_sum_of_costs(solution);
+  }
+  state.set_items_processed(explored);  // nodes/sec
+  state.set_note("explored=" + std::to_string(explored / state.iterations) +
+                 " soc=" + std::to_string(soc));  // soc=0 -> failed
+}
+BENCHMARK(BM_solve)
+    ->Args({32, 10, 50, 0})
+    ->Args({32, 10, 150, 0})
+    ->Args({64, 10, 200, 0})
+    ->Args({64, 10, 600, 0})
+    ->Args({64, 20, 100, 0})
+    ->Args({128, 10, 500, 0})
+    ->Args({128, 10, 2000, 0})
+    ->Args({256, 10, 1000, 0})
+    ->Iterations(1);
+
+// ---------------------------------------------------------------------------
+// stress corpus, 10k-100k agents on large maps
+// solve is not included, distance tables are |V| per agent
+
+static std::string corpus_dir = "./build/corpus";
+
+// same names as the stress_corpus target
+struct CorpusEntry {
+  const char* map;
+  const char* scen;
+  int N;
+};
+static const std::array<CorpusEntry, 4> CORPUS = {{
+    {"random-2000-2000-10.map", "random-2000-2000-10-100000.scen", 100000},
+    {"warehouse-1000-1000.map", "warehouse-1000-1000-50000.scen", 50000},
+    {"maze-1000-1000-2.map", "maze-1000-1000-2-10000.scen", 10000},
+    {"room-512-512-16.map", "room-512-512-16-10000.scen", 10000},
+}};
+
+static bool exists_corpus(State& state)
+{
+  const auto& entry = CORPUS[state.range(0)];
+  if (std::ifstream(corpus_dir + "/" + entry.scen).good()) return true;
+  state.skip(std::string("missing ") + entry.scen);
+  return false;
+}
+
+// loaded once, goals are replaced by starts for waiting solutions
+static Instance& get_corpus_instance(int k)
+{
+  static std::map<int, std::unique_ptr<Instance> > cache;
+  auto& ins = cache[k];
+  if (ins == nullptr) {
+    ins = std::make_unique<Instance>(corpus_dir + "/" + CORPUS[k].scen,
+                                     corpus_dir + "/" + CORPUS[k].map,
+                                     CORPUS[k].N);
+    ins->goals = ins->starts;
+  }
+  return *ins;
+}
+
+// map and scenario, args: corpus entry
+static void BM_corpus_load(State& state)
+{
+  if (!exists_corpus(state)) return;
+  const auto& entry = CORPUS[state.range(0)];
+  int cnt = 0;
+  for (auto _ : state) {
+    const auto ins = Instance(corpus_dir + "/" + entry.scen,
+                              corpus_dir + "/" + entry.map, entry.N);
+    cnt += ins.is_valid();
+  }
+  state.set_items_processed(state.iterations * entry.N);  // agents
+  state.set_note("valid=" + std::to_string(cnt == (int)state.iterations));
+}
+BENCHMARK(BM_corpus_load)->Args({0})->Args({1})->Args({2})->Args({3});
+
+// insertion of configurations to CLOSED, each with one moved agent
+static void BM_corpus_config_table(State& state)
+{
+  if (!exists_corpus(state)) return;
+  const auto& ins = get_corpus_instance(state.range(0));
+  auto table = ConfigTable(&ins.G, ins.N);
+  auto C = ins.starts;
+  size_t k = 0;
+  int cnt = 0;
+  for (auto _ : state) {
+    const auto i = k++ % ins.N;
+    Vertex* v = C[i];
+    if (!v->neighbor.empty()) C[i] = v->neighbor[k % v->neighbor.size()];
+    cnt += table.insert(C).second;
+  }
+  state.set_items_processed(state.iterations);  // configurations
+  state.set_note("new=" + std::to_string(cnt == (int)state.iterations));
+}
+BENCHMARK(BM_corpus_config_table)->Args({0})->Args({1})->Args({2})->Args({3});
+
+// validation and metrics of a waiting solution
+static void BM_corpus_validate(State& state)
+{
+  if (!exists_corpus(state)) return;
+  const auto& ins = get_corpus_instance(state.range(0));
+  const auto solution = Solution(16, ins.starts);
+  int cnt = 0, soc = 0;
+  for (auto _ : state) {
+    cnt += is_feasible_solution(ins, solution);
+    soc += get_metrics(solution).sum_of_costs;
+  }
+  state.set_items_processed(state.iterations * ins.N * solution.size());
+  state.set_note("valid=" + std::to_string(cnt == (int)state.iterations));
+}
+BENCHMARK(BM_corpus_validate)->Args({0})->Args({1})->Args({2})->Args({3});
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  std::string filter, csv_name;
+  double min_time = 0.2;
+  for (int k = 1; k + 1 < argc; k += 2) {
+    if (std::strcmp(argv[k], "--filter") == 0) filter = argv[k + 1];
+    if (std::strcmp(argv[k], "--csv") == 0) csv_name = argv[k + 1];
+    if (std::strcmp(argv[k], "--corpus") == 0) corpus_dir = argv[k + 1];
+    if (std::strcmp(argv[k], "--min_time") == 0)
+      min_time = std::stod(argv[k + 1]);
+  }
+
+  std::ofstream csv_file;
+  if (!csv_name.empty()) csv_file.open(csv_name, std::ios::out);
+  std::ostream& csv = csv_name.empty() ? std::cout : csv_file;
+  csv << "name,iterations,ns_per_op,items_per_sec,peak_rss_mb,note\n";
+
+  for (auto& b : get_benchmarks()) {
+    if (b->args_list.empty()) b->args_list.emplace_back();
+    for (auto& args : b->args_list) {
+      auto name = b->name;
+      for (auto a : args) name += "/" + std::to_string(a);
+      if (name.find(filter) == std::string::npos) continue;
+
+      // grow iterations until min_time is reached, as Google Benchmark
+      reset_peak_rss();
+      size_t n = b->fixed_iterations > 0 ? b->fixed_iterations : 1;
+      while (true) {
+        auto state = State(args, n);
+        b->fn(state);
+        if (state.skipped) {
+          csv << name << ",0,0,0,0," << state.note << "\n";
+          break;
+        }
+        const auto sec = state.elapsed_ns * 1e-9;
+        if (b->fixed_iterations == 0 && sec < min_time && n < 1000000000) {
+          n = std::max(n * 2, (size_t)(n * min_time * 1.4 /
+                                       std::max(sec, 1e-9)));
+          n = std::min(n, (size_t)1000000000);
+          continue;
+        }
+        const auto ns_per_op = state.elapsed_ns / state.iterations;
+        const auto items_per_sec = state.items / std::max(sec, 1e-9);
+        csv << name << "," << state.iterations << "," << ns_per_op << ","
+            << items_per_sec << "," << (read_peak_rss() >> 20) << ","
+            << state.note << "\n";
+        if (!csv_name.empty()) {
+          std::printf("%-32s %12.1f ns/op %14.0f items/s  %s\n",
+                      name.c_str(), ns_per_op, items_per_sec,
+                      state.note.c_str());
+        }
+        break;
+      }
+    }
+  }
+  return 0;
+}
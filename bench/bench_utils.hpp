@@ -0,0 +1,19 @@
+/*
+ * fixtures shared by benchmarks
+ */
+#pragma once
+
+#include <lacam.hpp>
+
+// synthetic map with random obstacles, saved to filename
+// unlike make_random_map of the generator, all components are kept
+inline bool save_random_map(const std::string& filename, int width,
+                            int height, float obstacle_ratio, int seed = 0)
+{
+  auto MT = std::mt19937(seed);
+  auto map = GridMap(width, height);
+  for (auto& c : map.cells) {
+    if (get_random_float(&MT) < obstacle_ratio) c = '@';
+  }
+  return map.save(filename);
+}
@@ -0,0 +1,94 @@
+/*
+ * solution validation, O(N^2) per timestep vs. occupancy arrays
+ * metrics, one sweep per metric vs. a single pass
+ * usage: build/bench_validate [map file] [N] [T]
+ */
+#include <lacam.hpp>
+
+#include "bench_utils.hpp"
+
+// reference: previous validator with nested loops
+static bool is_feasible_nested(const Instance& ins,
+                               const std::vector<Config>& solution)
+{
+  for (size_t t = 1; t < solution.size(); ++t) {
+    for (size_t i = 0; i < ins.N; ++i) {
+      auto v_i_from = solution[t - 1][i];
+      auto v_i_to = solution[t][i];
+      if (v_i_from != v_i_to &&
+          std::find(v_i_to->neighbor.begin(), v_i_to->neighbor.end(),
+                    v_i_from) == v_i_to->neighbor.end())
+        return false;
+      for (size_t j = i + 1; j < ins.N; ++j) {
+        auto v_j_from = solution[t - 1][j];
+        auto v_j_to = solution[t][j];
+        if (v_j_to == v_i_to) return false;
+        if (v_j_to == v_i_from && v_j_from == v_i_to) return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  std::string map_name = argc > 1 ? argv[1] : "";
+  const int N = argc > 2 ? std::stoi(argv[2]) : 5000;
+  const int T = argc > 3 ? std::stoi(argv[3]) : 200;
+  if (map_name.empty()) {
+    map_name = "/tmp/random-128-128-10.map";
+    save_random_map(map_name, 128, 128, 0.1);
+  }
+
+  // long collision-free solution by lifelong PIBT
+  auto MT = std::mt19937(0);
+  auto ins = Instance(map_name, &MT, N);
+  if (!ins.is_valid(1)) return 1;
+  auto planner = LifelongPlanner(ins, &MT);
+  auto configs = planner.plan(T);
+  configs.insert(configs.begin(), ins.starts);
+  ins.goals = configs.back();
+  std::printf("%s\tN=%d\tT=%d\n",
+              map_name.substr(map_name.find_last_of('/') + 1).c_str(), N, T);
+
+  const auto t_encode = Deadline();
+  const auto solution = Solution(configs);
+  std::printf("delta encoding    %9.1f ms  %zu / %zu KB\n",
+              t_encode.elapsed_ms(), solution.memory() >> 10,
+              (size_t)N * (T + 1) * sizeof(uint32_t) >> 10);
+
+  const auto t_nested = Deadline();
+  const auto ok_nested = is_feasible_nested(ins, configs);
+  std::printf("nested loops      %9.1f ms  valid=%d\n", t_nested.elapsed_ms(),
+              ok_nested);
+  for (auto threads : {1, 0}) {
+    const auto t_occupancy = Deadline();
+    const auto res = validate_solution(ins, solution, threads);
+    std::printf("occupancy (j=%d)  %9.1f ms  valid=%d\n", threads,
+                t_occupancy.elapsed_ms(), res.kind == Violation::NONE);
+  }
+
+  const auto t_separate = Deadline();
+  const auto soc = get_sum_of_costs(solution);
+  const auto loss = get_sum_of_loss(solution);
+  std::printf("metrics separate  %9.1f ms  soc=%d\tloss=%d\n",
+              t_separate.elapsed_ms(), soc, loss);
+  for (auto threads : {1, 0}) {
+    const auto t_single = Deadline();
+    const auto metrics = get_metrics(solution, threads);
+    std::printf("single pass (j=%d)%9.1f ms  soc=%d\tloss=%d\n", threads,
+                t_single.elapsed_ms(), metrics.sum_of_costs,
+                metrics.sum_of_loss);
+  }
+  auto tracker = MetricsTracker(solution.back());
+  auto solution_inc = Solution();
+  const auto t_tracker = Deadline();
+  for (auto& C : solution) {
+    solution_inc.push_back(C);
+    tracker.update(solution_inc);
+  }
+  std::printf("incremental       %9.1f ms  soc=%d\tloss=%d\n",
+              t_tracker.elapsed_ms(), tracker.get().sum_of_costs,
+              tracker.get().sum_of_loss);
+  return 0;
+}
@@ -0,0 +1,27 @@
+/*
+ * batch solving, many instances per process with worker threads
+ */
+#pragma once
+
+#include "instance.hpp"
+#include "utils.hpp"
+
+struct Job {
+  std::string map_name;
+  std::string scen_name;  // empty -> random instance
+  int N;                  // number of agents
+  int seed;
+  double time_limit_ms;
+};
+using Jobs = std::vector<Job>;
+
+// manifest: one job per line, "map scen N seed [time_limit_sec]"
+// scen "-" -> random instance, lines starting with '#' are ignored
+Jobs load_manifest(const std::string& filename,
+                   const double default_time_limit_ms);
+
+// solve jobs concurrently, each map is loaded once
+// one record per job is streamed to os in completion order
+// return the number of solved jobs
+int solve_batch(const Jobs& jobs, std::ostream& os, const int threads = 0,
+                const int verbose = 0);
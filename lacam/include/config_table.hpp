@@ -0,0 +1,67 @@
+/*
+ * hash table of configurations, stored as packed vertex-id arrays
+ * old chunks of packed configurations can be spilled to a temporary file
+ */
+#pragma once
+
+#include <cstdio>
+#include <memory>
+
+#include "graph.hpp"
+#include "solution.hpp"
+#include "utils.hpp"
+
+struct ConfigTable {
+  const Graph* G;
+  const int N;                   // number of agents
+  const int id_bytes;            // 2 or 4, depending on |V|
+  const size_t key_bytes;        // bytes of one packed configuration
+  static constexpr int CHUNK_SIZE = 1024;  // configurations per chunk
+
+  // packed configurations, CHUNK_SIZE per chunk, empty when spilled
+  std::vector<std::vector<uint8_t> > chunks;
+  std::vector<uint64_t> hashes;  // hash values, index: config-id
+  std::vector<int> slots;        // open addressing, config-id or -1
+  std::vector<uint8_t> buf;      // for packing a query
+
+  // spilled chunks, at offset chunk-index * CHUNK_SIZE * key_bytes
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> spill_file;
+  int spilled_chunks;
+  // reading spilled configurations failed, results are unreliable since
+  // the search should stop, see Planner::is_interrupted
+  mutable bool read_failed;
+
+  ConfigTable(const Graph* _G, const int _N);
+
+  int size() const;  // the number of stored configurations
+  int find(const Config& C);  // config-id, or -1 when not found
+  // insert if not found, return config-id and whether it is new
+  std::pair<int, bool> insert(const Config& C);
+  std::pair<int, bool> insert(const Config& C, const uint64_t hash);
+
+  uint64_t get_hash(const int k) const;
+  // the following read spilled configurations from disk
+  // on failure, read_failed is set and nullptr, false, or -1 is returned
+  Vertex* get(const int k, const int i) const;  // location of agent-i
+  bool unpack(const int k, Config& C) const;
+  bool is_same(const int k, const Config& C);  // compare with config-id k
+  // agents located differently in config-id k_to than in k_from, ascending
+  // packed configurations are compared without unpacking
+  bool get_moves(const int k_from, const int k_to,
+                 std::vector<Solution::Move>& moves) const;
+
+  size_t bytes() const;  // in memory, except the query buffers
+  // move the oldest full chunks to disk until freeing target bytes
+  // return freed bytes
+  size_t spill(const size_t target);
+
+private:
+  void pack(const Config& C);
+  int probe(const uint64_t hash) const;  // slot of config in buf, or empty one
+  // packed config-id k in memory, nullptr when spilled
+  const uint8_t* key(const int k) const;
+  // bytes [pos, pos + len) of packed config-id k, from memory or disk
+  bool read(const int k, const size_t pos, const size_t len, void* dst) const;
+  bool equals(const int k, const uint8_t* packed) const;
+  void grow();
+};
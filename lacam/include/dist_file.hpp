@@ -0,0 +1,49 @@
+/*
+ * precomputed distance fields on disk, loaded read-only by mmap
+ *
+ * layout (native endian):
+ *   DistFileHeader
+ *   goal vertex-ids, uint32 x num_goals
+ *   distance fields, dist_bytes x num_vertices x num_goals
+ *   dist_bytes is 2, or 4 when num_vertices does not fit in 16 bits
+ */
+#pragma once
+
+#include "graph.hpp"
+#include "utils.hpp"
+
+struct DistFileHeader {
+  char magic[8];  // "LACAMDF"
+  uint32_t version;
+  uint32_t num_vertices;
+  uint64_t map_hash;  // Graph::hash
+  uint32_t num_goals;
+  uint32_t dist_bytes;  // per vertex, 2 or 4
+};
+
+struct DistFile {
+  static constexpr char MAGIC[8] = "LACAMDF";
+  static constexpr uint32_t VERSION = 2;
+
+  const std::string filename;
+  void* data;  // mmap-ed region, nullptr when loading failed
+  size_t size;
+  const DistFileHeader* header;
+  const uint32_t* goals;
+  const uint8_t* fields;
+  std::unordered_map<int, int> index;  // goal vertex-id -> field
+
+  DistFile(const std::string& _filename);
+  DistFile(const DistFile&) = delete;
+  ~DistFile();
+
+  bool is_valid() const;
+  // field of the goal on the map, nullptr when not stored
+  // elements are of dist_bytes, i.e., uint16_t or uint32_t
+  const void* get(const uint64_t map_hash, const int goal_id) const;
+};
+
+// compute the distance fields for goals on G and save them
+// fields are written as computed, memory does not grow with goals
+bool write_dist_file(const std::string& filename, const Graph& G,
+                     const Vertices& goals);
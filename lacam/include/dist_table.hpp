@@ -1,23 +1,119 @@
 /*
  * distance table with lazy evaluation, using BFS
+ * eager mode: rows for all distinct goals are computed up front in parallel
  */
 #pragma once
 
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "dist_file.hpp"
 #include "graph.hpp"
 #include "instance.hpp"
 #include "utils.hpp"
 
+// distance fields, i.e., distances from one goal to all vertices
+// 16-bit per vertex when |V| fits, otherwise 32-bit
+inline size_t get_dist_bytes(const size_t K) { return K > 0xffff ? 4 : 2; }
+
+// full BFS from goal, field is sized |V|, unreachable -> |V|
+template <typename T>
+void fill_dist_field(const Graph& G, Vertex* goal, T* field);
+// width of the field is get_dist_bytes(|V|)
+void fill_dist_field(const Graph& G, Vertex* goal, void* field);
+
+// goal-keyed distance fields shared by all instances on the same map
+// thread-safe, least recently used fields are dropped beyond the budget
+// fields in attached files are used before BFS, not counted in the budget
+struct DistCache {
+  using Key = std::pair<uint64_t, int>;  // graph hash, goal vertex-id
+  struct KeyHasher {
+    size_t operator()(const Key& k) const;
+  };
+  struct Entry {
+    std::shared_ptr<const void> field;  // get_dist_bytes(|V|) per vertex
+    size_t bytes;
+    std::list<Key>::iterator pos;  // in lru
+  };
+
+  size_t budget;  // bytes, 0 -> disabled
+  size_t bytes;   // bytes of cached fields
+  int hit;
+  int miss;
+  mutable std::mutex mtx;  // guards all members
+  std::list<Key> lru;  // front: most recently used
+  std::unordered_map<Key, Entry, KeyHasher> fields;
+  std::vector<std::shared_ptr<const DistFile> > files;
+
+  static DistCache& get_instance();  // process-wide cache
+
+  DistCache(const size_t _budget = 0);
+  bool enabled() const;
+  void set_budget(const size_t _budget);
+  void attach(std::shared_ptr<const DistFile> file);
+  void clear();
+  std::shared_ptr<const void> get(const Graph& G, Vertex* goal);
+  void evict(const size_t limit);  // drop fields until bytes <= limit
+};
+
 struct DistTable {
-  const int K;  // number of vertices
-  std::vector<std::vector<int> >
-      table;  // distance table, index: agent-id & vertex-id
-  std::vector<std::queue<Vertex*> > OPEN;  // search queue
+  static bool FLG_EAGER;  // default mode, set by main
+
+  const Graph* G;
+  const int K;       // number of vertices
+  const bool eager;  // all rows are computed up front
+  const bool wide;   // K does not fit in 16 bits, rows are 32-bit
+
+  // rows of distances, index: agent-id, one of them is used
+  // unreachable or not yet searched -> K
+  std::vector<const uint16_t*> rows;
+  std::vector<const uint32_t*> rows32;
+
+  // owned rows; lazy: one per agent, eager: one per distinct goal
+  std::vector<uint16_t> dists;
+  std::vector<uint32_t> dists32;
+  std::vector<std::queue<int> > OPEN;  // lazy, search queue of vertex-ids
+  // for eager mode, rows shared with DistCache or replaced by set_goal
+  std::vector<std::shared_ptr<const void> > fields;
+  std::vector<std::shared_ptr<const void> > updated;  // index: agent-id
+
+  // eager mode is a row load, K falls back to lazy BFS or unreachable
+  int get(int i, int v_id)  // agent, vertex-id
+  {
+    const int d = wide ? rows32[i][v_id] : rows[i][v_id];
+    return d < K ? d : get_lazy(i, v_id);
+  }
+  int get(int i, Vertex* v) { return get(i, v->id); }  // agent, vertex
 
-  int get(int i, int v_id);   // agent, vertex-id
-  int get(int i, Vertex* v);  // agent, vertex
+  // lookups of get with the mode and row width fixed, see visit
+  // eager: a plain row load without the lazy fallback
+  template <typename T>
+  struct EagerLookup {
+    const T* const* rows;
+    int get(int i, int v_id) const { return rows[i][v_id]; }
+  };
+  struct LazyLookup {
+    DistTable* D;
+    int get(int i, int v_id) const { return D->get(i, v_id); }
+  };
+  // f(lookup), the lookup is chosen once per call instead of per get
+  template <typename F>
+  auto visit(F&& f)
+  {
+    if (!eager) return f(LazyLookup{this});
+    if (wide) return f(EagerLookup<uint32_t>{rows32.data()});
+    return f(EagerLookup<uint16_t>{rows.data()});
+  }
 
-  DistTable(const Instance& ins);
-  DistTable(const Instance* ins);
+  // eager mode is forced when the process-wide DistCache is enabled
+  DistTable(const Instance& ins, const bool _eager = FLG_EAGER);
+  DistTable(const Instance* ins, const bool _eager = FLG_EAGER);
+  DistTable(const DistTable&) = delete;  // rows refer to own storage
+  DistTable(DistTable&&) = default;
 
   void setup(const Instance* ins);  // initialization
+  void set_goal(int i, Vertex* goal);  // recompute the row of agent-i
+  int get_lazy(int i, int v_id);
+  void set_row(int i, const void* row);  // of get_dist_bytes(K) width
 };
@@ -0,0 +1,37 @@
+/*
+ * synthetic grid maps and scenarios, e.g., for stress tests
+ * maps are written in the format of MAPF benchmarks
+ */
+#pragma once
+
+#include "instance.hpp"
+#include "utils.hpp"
+
+struct GridMap {
+  int width;
+  int height;
+  std::string cells;  // row-major, '.' -> free, '@' -> obstacle
+
+  GridMap(int _width, int _height, char c = '.');
+  bool is_free(int x, int y) const;
+  void set(int x, int y, char c);
+  int count_free() const;
+  void keep_largest_component();  // other free cells become obstacles
+  bool save(const std::string& filename) const;
+};
+
+// obstacles placed independently
+GridMap make_random_map(int width, int height, float obstacle_ratio,
+                        std::mt19937* MT);
+// blocks of shelves separated by aisles, free border
+GridMap make_warehouse_map(int width, int height, int shelf_width = 10,
+                           int shelf_height = 2, int aisle = 2);
+// perfect maze of corridors, then walls are removed at loop_ratio
+GridMap make_maze_map(int width, int height, int corridor, float loop_ratio,
+                      std::mt19937* MT);
+// square rooms, neighboring rooms are connected by one door
+GridMap make_room_map(int width, int height, int room_size, std::mt19937* MT);
+
+// scenario of MAPF benchmarks, optimal lengths are not computed, i.e., 0
+bool save_scen(const std::string& filename, const std::string& map_name,
+               const Instance& ins);
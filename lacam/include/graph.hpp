@@ -4,37 +4,142 @@
 #pragma once
 #include "utils.hpp"
 
+struct Graph;
+
 struct Vertex {
   const int id;     // index for V in Graph
   const int index;  // index for U (width * y + x) in Graph
   std::vector<Vertex*> neighbor;
+  const Graph* G;  // owner
 
-  Vertex(int _id, int _index);
+  Vertex(int _id, int _index, const Graph* _G = nullptr);
 };
 using Vertices = std::vector<Vertex*>;
-using Config = std::vector<Vertex*>;  // locations for all agents
+
+// locations for all agents, stored as 32-bit vertex-ids of one graph
+// elements are read and assigned as Vertex* for compatibility
+struct Config {
+  static constexpr uint32_t NONE = UINT32_MAX;  // nullptr
+
+  std::vector<uint32_t> ids;  // index: agent
+  const Graph* G;             // set by the first assigned vertex
+
+  // proxy of an element
+  struct Ref {
+    Config& C;
+    const size_t i;
+    operator Vertex*() const { return C.get(i); }
+    Vertex* operator->() const { return C.get(i); }
+    Ref& operator=(Vertex* v)
+    {
+      C.set(i, v);
+      return *this;
+    }
+    Ref& operator=(const Ref& r) { return *this = (Vertex*)r; }
+  };
+
+  struct Iterator {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Vertex*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Vertex**;
+    using reference = Vertex*;
+    const Config* C;
+    size_t i;
+    Vertex* operator*() const { return C->get(i); }
+    Iterator& operator++()
+    {
+      ++i;
+      return *this;
+    }
+    bool operator!=(const Iterator& other) const { return i != other.i; }
+    bool operator==(const Iterator& other) const { return i == other.i; }
+  };
+
+  Config() : G(nullptr) {}
+  Config(size_t N, Vertex* v) : ids(N, NONE), G(nullptr)
+  {
+    for (size_t i = 0; i < N && v != nullptr; ++i) set(i, v);
+  }
+  Config(std::initializer_list<Vertex*> vs) : G(nullptr)
+  {
+    for (auto v : vs) push_back(v);
+  }
+  explicit Config(const Vertices& vs) : G(nullptr)
+  {
+    for (auto v : vs) push_back(v);
+  }
+  operator Vertices() const { return Vertices(begin(), end()); }
+
+  Vertex* get(size_t i) const;
+  void set(size_t i, Vertex* v)
+  {
+    if (v == nullptr) {
+      ids[i] = NONE;
+      return;
+    }
+    ids[i] = v->id;
+    G = v->G;
+  }
+
+  size_t size() const { return ids.size(); }
+  bool empty() const { return ids.empty(); }
+  void clear() { ids.clear(); }
+  void resize(size_t N) { ids.resize(N, NONE); }
+  void reserve(size_t N) { ids.reserve(N); }
+  void push_back(Vertex* v)
+  {
+    ids.push_back(NONE);
+    set(ids.size() - 1, v);
+  }
+  Ref operator[](size_t i) { return Ref{*this, i}; }
+  Vertex* operator[](size_t i) const { return get(i); }
+  Vertex* front() const { return get(0); }
+  Vertex* back() const { return get(ids.size() - 1); }
+  Iterator begin() const { return Iterator{this, 0}; }
+  Iterator end() const { return Iterator{this, ids.size()}; }
+  bool operator==(const Config& other) const { return ids == other.ids; }
+  bool operator!=(const Config& other) const { return ids != other.ids; }
+};
 
 struct Graph {
-  Vertices V;  // without nullptr
-  Vertices U;  // with nullptr, i.e., |U| = width * height
-  int width;   // grid width
-  int height;  // grid height
+  std::vector<Vertex> vertices;  // storage of V, contiguous
+  Vertices V;     // without nullptr
+  Vertices U;     // with nullptr, i.e., |U| = width * height
+  int width;      // grid width
+  int height;     // grid height
+  uint64_t hash;  // content hash, identical for the same map
+
+  // compressed sparse row of edges, for cache-friendly traversal
+  // neighbors of vertex-id v: adj[adj_offsets[v]], ..., adj[adj_offsets[v+1]-1]
+  std::vector<int> adj_offsets;  // size |V| + 1
+  std::vector<int> adj;          // neighbor vertex-ids, same order as neighbor
   Graph();
   Graph(const std::string& filename);  // taking map filename
+  Graph(const Graph&) = delete;        // V refers to own storage
   ~Graph();
 
   int size() const;  // the number of vertices, |V|
 };
 
+inline Vertex* Config::get(size_t i) const
+{
+  return ids[i] == NONE ? nullptr : G->V[ids[i]];
+}
+inline size_t size(const Config& C) { return C.size(); }  // as std::size
+
 bool is_same_config(
     const Config& C1,
     const Config& C2);  // check equivalence of two configurations
 
-// hash function of configuration
-// c.f.
-// https://stackoverflow.com/questions/10405030/c-unordered-map-fail-when-used-with-a-vector-as-key
+// Zobrist hashing of configuration, i.e., XOR of keys for (agent, vertex)
+// keys are generated on the fly by splitmix64, so no O(N|V|) table is kept
 struct ConfigHasher {
-  uint operator()(const Config& C) const;
+  static uint64_t key(const int i, const int v_id);  // agent-i at vertex
+  // incremental update when agent-i moves from v_from to v_to
+  static uint64_t update(const uint64_t hash, const int i, Vertex* v_from,
+                         Vertex* v_to);
+  uint64_t operator()(const Config& C) const;  // full computation
 };
 
 std::ostream& operator<<(std::ostream& os, const Vertex* v);
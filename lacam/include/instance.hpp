@@ -2,16 +2,19 @@
  * instance definition
  */
 #pragma once
+#include <memory>
 #include <random>
 
 #include "graph.hpp"
+#include "solution.hpp"
 #include "utils.hpp"
 
 struct Instance {
-  const Graph G;  // graph
-  Config starts;  // initial configuration
-  Config goals;   // goal configuration
-  const uint N;   // number of agents
+  const std::shared_ptr<const Graph> G_ptr;  // graph, shareable
+  const Graph& G;                            // graph
+  Config starts;                             // initial configuration
+  Config goals;                              // goal configuration
+  const uint N;                              // number of agents
 
   // for testing
   Instance(const std::string& map_filename,
@@ -20,13 +23,14 @@ struct Instance {
   // for MAPF benchmark
   Instance(const std::string& scen_filename, const std::string& map_filename,
            const int _N = 1);
+  Instance(const std::string& scen_filename,
+           std::shared_ptr<const Graph> _G,  // loaded graph
+           const int _N = 1);
   // random instance generation
   Instance(const std::string& map_filename, std::mt19937* MT, const int _N = 1);
+  Instance(std::shared_ptr<const Graph> _G, std::mt19937* MT, const int _N = 1);
   ~Instance() {}
 
   // simple feasibility check of instance
   bool is_valid(const int verbose = 0) const;
 };
-
-// solution: a sequence of configurations
-using Solution = std::vector<Config>;
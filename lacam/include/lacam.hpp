@@ -1,8 +1,17 @@
 #pragma once
 
+#include "batch.hpp"
+#include "config_table.hpp"
+#include "dist_file.hpp"
 #include "dist_table.hpp"
+#include "generator.hpp"
 #include "graph.hpp"
 #include "instance.hpp"
+#include "lifelong.hpp"
+#include "parallel_planner.hpp"
 #include "planner.hpp"
 #include "post_processing.hpp"
+#include "profile.hpp"
+#include "solution.hpp"
+#include "solution_file.hpp"
 #include "utils.hpp"
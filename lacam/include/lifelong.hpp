@@ -0,0 +1,29 @@
+/*
+ * lifelong planning, goals are updated while agents keep moving
+ */
+#pragma once
+
+#include "planner.hpp"
+
+struct LifelongPlanner {
+  Instance ins;     // starts: current configuration, goals: current goals
+  DistTable D;      // eager, rows are recomputed only for changed goals
+  Planner planner;  // for PIBT
+  std::vector<float> priorities;
+  std::vector<int> order;
+  Constraint root;  // no constraints, i.e., plain PIBT
+
+  LifelongPlanner(const Instance& _ins, std::mt19937* MT = nullptr);
+  LifelongPlanner(const LifelongPlanner&) = delete;
+
+  const Config& get_config() const;
+  void set_goal(const int i, Vertex* v);  // for agent-i
+  // advance k timesteps, return the configurations after each step
+  std::vector<Config> plan(const int k = 1);
+  // single step from C towards goals, valid until the next call
+  // no heap allocation unless goals change
+  const Config& step(const Config& C, const Config& goals);
+
+private:
+  void advance();  // one PIBT step of the current configuration
+};
@@ -0,0 +1,51 @@
+/*
+ * LaCAM with the high-level search shared among threads
+ */
+#pragma once
+
+#include <deque>
+#include <mutex>
+
+#include "planner.hpp"
+
+// CLOSED shared among threads, split into shards with own locks
+// node-id = local config-id * SHARDS + shard
+struct SharedClosed {
+  static constexpr int SHARDS = 64;
+  struct Shard {
+    std::mutex mtx;
+    ConfigTable table;
+    Nodes nodes;  // index: local config-id
+    Shard(const Graph* G, const int N) : table(G, N) {}
+  };
+  std::vector<std::unique_ptr<Shard> > shards;
+
+  SharedClosed(const Graph* G, const int N);
+  ~SharedClosed();  // nodes are destructed, their memory is not owned
+
+  int size() const;
+  // insert if not found, a new node is created in arena
+  std::pair<Node*, bool> insert(const Config& C, const uint64_t hash,
+                                Node* parent, Arena& arena);
+  uint64_t unpack(const Node* S, Config& C);  // return hash of S
+};
+
+// DFS stack of one thread, the bottom can be stolen by others
+struct WorkDeque {
+  std::mutex mtx;
+  std::deque<Node*> nodes;
+  std::atomic<size_t> size;
+
+  WorkDeque() : size(0) {}
+  void push_back(Node* S);
+  Node* pop_back();   // for owner
+  Node* pop_front();  // for thieves
+};
+
+// threads expand nodes in parallel, deduplicated by the shared CLOSED
+// thread-0 is not randomized, thread-k uses seed + k
+// Planner::FLG_ANYTIME is ignored, the first solution is returned
+Solution solve_parallel(const Instance& ins, const int threads,
+                        const int verbose = 0,
+                        const Deadline* deadline = nullptr,
+                        const int seed = 0);
@@ -3,36 +3,72 @@
  */
 #pragma once
 
+#include <atomic>
+#include <map>
+
+#include "config_table.hpp"
 #include "dist_table.hpp"
 #include "graph.hpp"
 #include "instance.hpp"
+#include "post_processing.hpp"
 #include "utils.hpp"
 
-// low-level search node
+// low-level search node, linked to its parent
 struct Constraint {
-  std::vector<int> who;
-  Vertices where;
+  Constraint* const parent;
+  const int who;        // agent
+  Vertex* const where;  // location
   const int depth;
+  Constraint* next;  // in the queue of the high-level node
   Constraint();
-  Constraint(Constraint* parent, int i, Vertex* v);  // who and where
-  ~Constraint();
+  Constraint(Constraint* _parent, int i, Vertex* v);  // who and where
+};
+
+// FIFO of constraints, linked through Constraint::next
+struct ConstraintQueue {
+  Constraint* head;
+  Constraint* tail;
+
+  ConstraintQueue() : head(nullptr), tail(nullptr) {}
+  bool empty() const { return head == nullptr; }
+  Constraint* front() const { return head; }
+  void push(Constraint* M);
+  void pop();
 };
 
-// high-level search node
+// high-level search node, see AnytimeNode for anytime refinement
 struct Node {
-  const Config C;
+  const int id;  // index of configuration in CLOSED
   Node* parent;
 
-  // for low-level search
+  // for low-level search, priorities and order are set on first expansion
   std::vector<float> priorities;
   std::vector<int> order;
-  std::queue<Constraint*> search_tree;
+  ConstraintQueue search_tree;
+  Constraint root;  // root of the low-level search
 
-  Node(Config _C, DistTable& D, Node* _parent = nullptr);
-  ~Node();
+  Node(const int _id, Node* _parent = nullptr);
+  bool is_ready() const;  // priorities and order are set
+  // free data for the low-level search, only for fully expanded nodes
+  void compact();
+  bool is_compact() const;
+  // free priorities, see Planner::restore_priorities
+  void evict();
 };
 using Nodes = std::vector<Node*>;
 
+// side table of Node for anytime refinement, index: config-id
+struct AnytimeNode {
+  std::map<Node*, int> neighbor;  // successors with edge costs, for g
+  int g;                          // cost from the start, i.e., sum of loss
+  int h;                          // sum of distances to goals, set with order
+};
+
+// stable sort of agents by descending priorities, the others are buffers
+void sort_order(const std::vector<float>& priorities, std::vector<int>& order,
+                std::vector<uint32_t>& keys, std::vector<uint32_t>& keys_buf,
+                std::vector<int>& order_buf);
+
 // PIBT agent
 struct Agent {
   const int id;
@@ -42,32 +78,91 @@ struct Agent {
 };
 using Agents = std::vector<Agent*>;
 
-// next location candidates, for saving memory allocation
-using Candidates = std::vector<std::array<Vertex*, 5> >;
+// next location candidates as vertex-ids, for saving memory allocation
+using Candidates = std::vector<std::array<int, 5> >;
 
 struct Planner {
+  // keep refining the solution until the deadline, in solve only
+  // solve_portfolio and solve_parallel do not support it
+  static bool FLG_ANYTIME;
+  static constexpr float RESTART_RATE = 0.001;  // in anytime refinement
+  static size_t MEMORY_BUDGET;  // bytes of search data, 0 -> unlimited
+
   const Instance* ins;
   const Deadline* deadline;
   std::mt19937* MT;
   const int verbose;
+  const std::atomic<bool>* stop;  // cooperative cancellation, or nullptr
 
   // solver utils
   const int N;  // number of agents
   const int V_size;
-  DistTable D;
+  std::unique_ptr<DistTable> D_owned;  // nullptr when shared
+  DistTable& D;
   Candidates C_next;                // next location candidates
+  std::vector<uint32_t> sort_keys;  // for sorting agents by priorities
+  std::vector<uint32_t> sort_keys_buf;
+  std::vector<int> sort_buf;
   std::vector<float> tie_breakers;  // random values, used in PIBT
   Agents A;
   Agents occupied_now;   // for quick collision checking
   Agents occupied_next;  // for quick collision checking
+  // entries of occupied_now are valid only when stamped with generation
+  std::vector<uint32_t> occupied_now_gen;
+  uint32_t generation;
+  Agents touched;  // agents with v_next, to reset occupied_next cheaply
+
+  // stats of get_new_config
+  int cnt_attempts;
+  int cnt_configs;  // successfully generated
+
+  // stats of memory budget
+  int cnt_compacted;     // nodes
+  int cnt_evicted;       // priorities of nodes
+  size_t spilled_bytes;  // of CLOSED
+  // explored configurations, created by solve, unused by PIBT-only callers
+  std::unique_ptr<ConfigTable> CLOSED;
+  std::vector<AnytimeNode> anytime;  // empty unless FLG_ANYTIME
+  Metrics metrics;  // of the last solution, tracked in backtracking
 
+  // a shared distance table must be read-only, i.e., eager
   Planner(const Instance* _ins, const Deadline* _deadline, std::mt19937* _MT,
-          int _verbose = 0);
+          int _verbose = 0, DistTable* _D = nullptr,
+          const std::atomic<bool>* _stop = nullptr);
+  ~Planner();
   Solution solve();
-  bool get_new_config(Node* S, Constraint* M);
-  bool funcPIBT(Agent* ai);
+  // deadline, stop flag, or failure of reading spilled configurations
+  bool is_interrupted() const;
+  // next configuration from C, agents follow order, constrained by M
+  bool get_new_config(const Config& C, const std::vector<int>& order,
+                      Constraint* M);
+  template <typename Lookup>  // of DistTable::visit
+  bool funcPIBT(Agent* ai, const Lookup& dist);
+  Agent* get_occupied_now(const int v_id) const;
+
+  // priorities and order on first expansion, C is the config of S
+  // return h, a by-product of priorities, no extra distance lookups
+  int setup_node(Node* S, const Config& C);
+  void restore_priorities(Node* S);  // of an evicted node, via its ancestors
+  // compact and evict nodes off the path to S_top, then spill CLOSED
+  // until fitting in MEMORY_BUDGET
+  void fit_memory(const Nodes& nodes, const Arena& arena, Node* S_top);
+
+  // for anytime refinement
+  int get_edge_cost(const Config& C_from, const Config& C_to) const;
+  // edge S_from -> S_to of cost, then propagate cheaper g to descendants
+  void rewrite(Node* S_from, Node* S_to, const int cost, Node* S_goal);
 };
 
-// main function
+// main function, metrics of the solution are stored when given
 Solution solve(const Instance& ins, const int verbose = 0,
-               const Deadline* deadline = nullptr, std::mt19937* MT = nullptr);
+               const Deadline* deadline = nullptr, std::mt19937* MT = nullptr,
+               Metrics* metrics = nullptr);
+
+// race planners with different seeds on threads, return the first result
+// planner-0 is not randomized, planner-k uses seed + k
+// Planner::FLG_ANYTIME must be off, otherwise all planners run to the deadline
+Solution solve_portfolio(const Instance& ins, const int threads,
+                         const int verbose = 0,
+                         const Deadline* deadline = nullptr,
+                         const int seed = 0);
@@ -4,10 +4,65 @@
 #pragma once
 #include "dist_table.hpp"
 #include "instance.hpp"
+#include "solution_file.hpp"
 #include "utils.hpp"
 
+// first violation of a solution, by time, then agent, then kind
+struct Violation {
+  enum Kind {
+    NONE,
+    INVALID_START,
+    INVALID_GOAL,
+    INVALID_MOVE,
+    VERTEX_CONFLICT,
+    SWAP_CONFLICT,  // agent is the smaller id of the pair
+  };
+  Kind kind;
+  int agent;
+  int time;  // destination timestep of the transition
+
+  Violation(Kind _kind = NONE, int _agent = -1, int _time = -1)
+      : kind(_kind), agent(_agent), time(_time)
+  {
+  }
+  bool operator<(const Violation& other) const;
+};
+std::ostream& operator<<(std::ostream& os, const Violation& violation);
+
+// occupancy arrays updated by moves, chunks of timesteps run in parallel
+Violation validate_solution(const Instance& ins, const Solution& solution,
+                            const int threads = 0);
 bool is_feasible_solution(const Instance& ins, const Solution& solution,
                           const int verbose = 0);
+// solution quality, all computed in one pass
+struct Metrics {
+  int makespan;
+  int sum_of_costs;
+  int sum_of_loss;
+  std::vector<int> path_costs;  // index: agent
+
+  Metrics() : makespan(0), sum_of_costs(0), sum_of_loss(0), path_costs() {}
+};
+// one pass over moves, chunks of timesteps in parallel for long solutions
+// then merged in parallel across agents, threads: 0 -> all cores
+Metrics get_metrics(const Solution& solution, const int threads = 0);
+
+// metrics of a solution growing timestep by timestep, e.g., in backtracking
+// only moves of appended timesteps are consumed
+// sum_of_loss assumes that the solution ends at goals
+struct MetricsTracker {
+  const Config goals;
+  size_t T;                     // number of consumed timesteps
+  Config C;                     // configuration at T-1
+  std::vector<int> since;       // arrival at the current vertex
+  std::vector<int> path_costs;  // last timestep of moves
+  int stays;                    // timesteps at goals before leaving them
+
+  MetricsTracker(const Config& _goals);
+  void update(const Solution& solution);  // consume new timesteps
+  Metrics get() const;
+};
+
 int get_makespan(const Solution& solution);
 int get_path_cost(const Solution& solution, int i);  // single-agent path cost
 int get_sum_of_costs(const Solution& solution);
@@ -16,8 +71,20 @@ int get_makespan_lower_bound(const Instance& ins, DistTable& D);
 int get_sum_of_costs_lower_bound(const Instance& ins, DistTable& D);
 void print_stats(const int verbose, const Instance& ins,
                  const Solution& solution, const double comp_time_ms);
+void print_stats(const int verbose, const Instance& ins,
+                 const Metrics& metrics, const double comp_time_ms);
 void make_log(const Instance& ins, const Solution& solution,
               const std::string& output_name, const double comp_time_ms,
               const std::string& map_name, const int seed,
               const bool log_short = false  // true -> paths not appear
 );
+// "key=value" lines at the head of logs
+std::string get_log_meta(const Instance& ins, const Solution& solution,
+                         const Metrics& metrics, const double comp_time_ms,
+                         const std::string& map_name, const int seed);
+enum struct LogFormat { TEXT, BINARY, BINARY_RLE };
+void make_log(const Instance& ins, const Solution& solution,
+              const Metrics& metrics, const std::string& output_name,
+              const double comp_time_ms, const std::string& map_name,
+              const int seed, const bool log_short = false,
+              const LogFormat format = LogFormat::TEXT);
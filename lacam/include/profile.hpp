@@ -0,0 +1,81 @@
+/*
+ * hot-path counters of the planner
+ * compiled out unless built with -DLACAM_PROFILE=ON
+ */
+#pragma once
+
+#include "utils.hpp"
+
+struct Profile {
+  enum Counter {
+    EXPANSIONS,          // high-level, one per search loop
+    CONSTRAINTS,         // low-level nodes given to get_new_config
+    FAIL_VERTEX,         // constraints occupying the same vertex
+    FAIL_SWAP,           // constraints swapping agents
+    FAIL_PIBT,           // PIBT could not move an agent
+    PIBT_CALLS,          // funcPIBT, including recursive ones
+    PIBT_MAX_DEPTH,      // merged by max
+    BFS_EXPANSIONS,      // vertices popped by lazy or eager BFS
+    CLOSED_HITS,         // known configurations
+    CLOSED_MISSES,       // new configurations
+    ALLOC_BYTES,         // handed out by arenas
+    TIME_EXPANSION_NS,   // search loop
+    TIME_NEW_CONFIG_NS,  // get_new_config
+    TIME_BFS_NS,         // DistTable::get with BFS
+    NUM_COUNTERS,
+  };
+  static const char* NAMES[NUM_COUNTERS];
+
+  std::array<uint64_t, NUM_COUNTERS> counts;
+  int depth;  // current recursion of funcPIBT
+
+  Profile();
+  void merge(const Profile& other);
+
+  // thread_local, no locks on hot paths, merged into the total at exit
+  static Profile& local();
+  static Profile get();  // total of finished threads and this thread
+  static void reset();
+  static std::string to_json();
+};
+
+// scoped timer adding elapsed nanoseconds to a counter
+struct ProfileTimer {
+  const Profile::Counter counter;
+  const Time::time_point t_s;
+
+  ProfileTimer(const Profile::Counter _counter)
+      : counter(_counter), t_s(Time::now())
+  {
+  }
+  ~ProfileTimer()
+  {
+    Profile::local().counts[counter] +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Time::now() - t_s)
+            .count();
+  }
+};
+
+// scoped recursion depth of funcPIBT
+struct ProfileDepth {
+  ProfileDepth()
+  {
+    auto& p = Profile::local();
+    auto& d = p.counts[Profile::PIBT_MAX_DEPTH];
+    if ((uint64_t)++p.depth > d) d = p.depth;
+  }
+  ~ProfileDepth() { --Profile::local().depth; }
+};
+
+#ifdef LACAM_PROFILE
+#define PROFILE_ADD(counter, x) \
+  (Profile::local().counts[Profile::counter] += (x))
+#define PROFILE_TIMER(counter) \
+  ProfileTimer profile_timer_##counter(Profile::counter)
+#define PROFILE_DEPTH() ProfileDepth profile_depth
+#else
+#define PROFILE_ADD(counter, x) ((void)0)
+#define PROFILE_TIMER(counter) ((void)0)
+#define PROFILE_DEPTH() ((void)0)
+#endif
+#define PROFILE_COUNT(counter) PROFILE_ADD(counter, 1)
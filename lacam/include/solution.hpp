@@ -0,0 +1,112 @@
+/*
+ * solution definition, i.e., a sequence of configurations
+ * stored as moves per timestep, so memory scales with movement
+ * moves are bit-packed, widths fit the number of agents and |V|
+ */
+#pragma once
+#include "graph.hpp"
+
+struct Solution {
+  static constexpr size_t KEYFRAME_INTERVAL = 64;  // timesteps
+
+  // agent moved to vertex-id, at some timestep, unpacked form
+  struct Move {
+    uint32_t agent;
+    uint32_t to;
+  };
+
+  // proxy of a configuration
+  struct Ref {
+    Solution& solution;
+    const size_t t;
+    operator Config() const { return solution.get(t); }
+    Vertex* operator[](size_t i) const { return solution.get(t, i); }
+    bool operator==(const Config& C) const { return solution.get(t) == C; }
+    bool operator!=(const Config& C) const { return solution.get(t) != C; }
+    Ref& operator=(const Config& C)
+    {
+      solution.set(t, C);
+      return *this;
+    }
+  };
+
+  // configurations from the start, by applying moves
+  struct Iterator {
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Config;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Config*;
+    using reference = const Config&;
+    const Solution* solution;
+    size_t t;
+    Config C;  // configuration at t
+    const Config& operator*() const { return C; }
+    const Config* operator->() const { return &C; }
+    Iterator& operator++()
+    {
+      if (++t < solution->size()) solution->apply(t, C);
+      return *this;
+    }
+    bool operator!=(const Iterator& other) const { return t != other.t; }
+    bool operator==(const Iterator& other) const { return t == other.t; }
+  };
+
+  const Graph* G;
+  size_t N;  // number of agents
+  // moves by timestep, then by agent, as agent | (vertex-id + 1) << agent_bits
+  // the vertex field is 0 for Config::NONE, widths are set by assign
+  std::vector<uint64_t> packed;
+  size_t num_moves;
+  int agent_bits;
+  int move_bits;                    // agent_bits plus bits of the vertex field
+  // moves at t: [offsets[t], offsets[t+1]), up to 2^32 moves in total
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> keyframes;  // configurations at k * KEYFRAME_INTERVAL
+  Config last;                      // last configuration
+
+  Solution() : G(nullptr), N(0), num_moves(0), agent_bits(0), move_bits(0) {}
+  explicit Solution(size_t T, const Config& C = Config());
+  Solution(std::initializer_list<Config> configs);
+  explicit Solution(const std::vector<Config>& configs);
+
+  size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+  bool empty() const { return offsets.empty(); }
+  void clear();
+  void assign(size_t T, const Config& C);  // T copies of C
+  // only agents that moved from the last configuration are recorded
+  void push_back(const Config& C);
+  // the same from moves in ascending order of agents, without the full
+  // configuration; the solution must not be empty
+  void push_moves(const std::vector<Move>& moves);
+  // random access, through the latest keyframe until t
+  Config get(size_t t) const;
+  Vertex* get(size_t t, size_t i) const;
+  // rewrite moves at t and t+1, O(|moves|), for tests and tools
+  // a solution without agents, e.g., Solution(T), takes the size of C
+  void set(size_t t, const Config& C);
+  // C: configuration at t-1 -> at t
+  void apply(size_t t, Config& C) const;
+  Move get_move(size_t k) const  // k-th move, see offsets
+  {
+    const auto pos = k * move_bits;
+    const auto w = pos >> 6;
+    const auto off = pos & 63;
+    auto x = packed[w] >> off;
+    if (off + move_bits > 64) x |= packed[w + 1] << (64 - off);
+    if (move_bits < 64) x &= (uint64_t(1) << move_bits) - 1;
+    return Move{(uint32_t)(x & ((uint64_t(1) << agent_bits) - 1)),
+                (uint32_t)(x >> agent_bits) - 1};
+  }
+  void push_move(const Move& m);
+  size_t memory() const;  // bytes
+
+  Config operator[](size_t t) const { return get(t); }
+  Ref operator[](size_t t) { return Ref{*this, t}; }
+  Config front() const { return get(0); }
+  const Config& back() const { return last; }
+  Iterator begin() const;
+  Iterator end() const { return Iterator{this, size(), Config()}; }
+
+private:
+  void close_timestep();  // after the moves of the new last timestep
+};
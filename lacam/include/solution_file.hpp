@@ -0,0 +1,67 @@
+/*
+ * binary solution log, compact alternative to the text log of make_log
+ *
+ * layout (native endian):
+ *   SolutionFileHeader
+ *   metadata, "key=value\n" lines of the text log, char x meta_size
+ *   padding to 8 bytes
+ *   body, uint64 words, values packed at the minimal bit width, LSB first
+ *     starts and goals, vertex index x num_agents each
+ *     raw: vertex index x num_agents x num_timesteps, timestep-major
+ *     rle: per agent, number of runs, then (vertex index, length) x runs
+ * vertex index = y * width + x, as in the text log
+ */
+#pragma once
+
+#include "instance.hpp"
+#include "utils.hpp"
+
+struct SolutionFileHeader {
+  char magic[8];  // "LACAMSL"
+  uint32_t version;
+  uint32_t flags;
+  uint32_t width;
+  uint32_t height;
+  uint32_t num_agents;
+  uint32_t num_timesteps;  // solution length, not makespan
+  uint32_t vertex_bits;
+  uint32_t run_bits;  // for run lengths and counts, rle only
+  uint64_t meta_size;
+  uint64_t body_words;
+};
+
+// decoded content, vertices are indexes on the grid
+struct SolutionLog {
+  static constexpr char MAGIC[8] = "LACAMSL";
+  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t FLG_RLE = 1;
+  static constexpr uint32_t FLG_SHORT = 2;  // without paths
+
+  int width;  // negative when loading failed
+  int height;
+  bool log_short;
+  std::string meta;
+  std::vector<int> starts;
+  std::vector<int> goals;
+  std::vector<std::vector<int> > solution;  // timestep x agent, when loaded
+  // configurations are streamed from it instead, borrowed
+  const Solution* source;
+
+  SolutionLog()
+      : width(-1), height(-1), log_short(false), source(nullptr)
+  {
+  }
+  SolutionLog(const Instance& ins, const Solution& _solution,
+              const std::string& _meta, const bool _log_short = false);
+  bool is_valid() const;
+  size_t size() const;  // number of timesteps
+  // f(t, vertex indexes at t) for each timestep
+  void for_each(
+      const std::function<void(size_t, const std::vector<int>&)>& f) const;
+};
+
+bool write_solution_file(const std::string& filename, const SolutionLog& log,
+                         const bool rle = true);
+SolutionLog read_solution_file(const std::string& filename);
+// same format as make_log, for the visualizer
+bool write_text_log(const std::string& filename, const SolutionLog& log);
@@ -6,14 +6,17 @@
 #include <array>
 #include <chrono>
 #include <climits>
+#include <cstdint>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <new>
 #include <numeric>
 #include <queue>
 #include <random>
-#include <regex>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -46,4 +49,42 @@ double elapsed_ms(const Deadline* deadline);
 double elapsed_ns(const Deadline* deadline);
 bool is_expired(const Deadline* deadline);
 
+// read the whole file into buf, false if not found
+bool read_file(const std::string& filename, std::string& buf);
+// next line of buf from pos without CR/LF, false at the end
+bool next_line(const std::string& buf, size_t& pos, std::string_view& line);
+// non-negative integer consisting only of digits
+bool parse_uint(std::string_view s, int& x);
+
 float get_random_float(std::mt19937* MT, float from = 0, float to = 1);
+int get_random_int(std::mt19937* MT, int from, int to);  // inclusive
+
+size_t get_peak_rss();  // bytes, of this process
+
+// run f(k) for k = 0, ..., n-1 by worker threads, 0 -> all cores
+void parallel_for(const size_t n, const std::function<void(size_t)>& f,
+                  const int threads = 0);
+
+// bump allocator, objects are released all at once
+// note: destructors are not called by Arena
+struct Arena {
+  const size_t chunk_size;
+  std::vector<char*> chunks;
+  size_t used;       // used bytes of the last chunk
+  size_t allocated;  // total bytes handed out
+
+  Arena(size_t _chunk_size = 1 << 20);
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  ~Arena();
+
+  void* allocate(size_t size, size_t align);
+  void release();
+
+  template <typename T, typename... Args>
+  T* create(Args&&... args)
+  {
+    return new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+};
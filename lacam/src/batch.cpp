@@ -0,0 +1,109 @@
+#include "../include/batch.hpp"
+
+#include <mutex>
+#include <sstream>
+
+#include "../include/planner.hpp"
+#include "../include/post_processing.hpp"
+
+Jobs load_manifest(const std::string& filename,
+                   const double default_time_limit_ms)
+{
+  Jobs jobs;
+  std::string buf;
+  if (!read_file(filename, buf)) {
+    info(0, 0, filename, " is not found");
+    return jobs;
+  }
+  size_t pos = 0;
+  std::string_view line;
+  while (next_line(buf, pos, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream iss{std::string(line)};
+    Job job;
+    double time_limit_sec = -1;
+    if (!(iss >> job.map_name >> job.scen_name >> job.N >> job.seed)) {
+      info(0, 0, "skip invalid job: ", line);
+      continue;
+    }
+    iss >> time_limit_sec;
+    if (job.scen_name == "-") job.scen_name.clear();
+    job.time_limit_ms =
+        time_limit_sec >= 0 ? time_limit_sec * 1000 : default_time_limit_ms;
+    jobs.push_back(job);
+  }
+  return jobs;
+}
+
+int solve_batch(const Jobs& jobs, std::ostream& os, const int threads,
+                const int verbose)
+{
+  const auto deadline = Deadline();
+
+  // load each map once
+  std::vector<std::string> map_names;
+  std::unordered_map<std::string, int> map_index;
+  for (auto& job : jobs) {
+    if (map_index.emplace(job.map_name, map_names.size()).second) {
+      map_names.push_back(job.map_name);
+    }
+  }
+  std::vector<std::shared_ptr<const Graph> > graphs(map_names.size());
+  parallel_for(
+      map_names.size(),
+      [&](size_t k) {
+        graphs[k] = std::make_shared<const Graph>(map_names[k]);
+      },
+      threads);
+  info(1, verbose, "elapsed:", elapsed_ms(&deadline), "ms\tloaded ",
+       graphs.size(), " maps");
+
+  // worker pool
+  std::mutex mtx;
+  int solved_cnt = 0;
+  parallel_for(
+      jobs.size(),
+      [&](size_t k) {
+        const auto& job = jobs[k];
+        auto MT = std::mt19937(job.seed);
+        const auto& G = graphs[map_index.at(job.map_name)];
+        const auto ins = job.scen_name.empty()
+                             ? Instance(G, &MT, job.N)
+                             : Instance(job.scen_name, G, job.N);
+        bool solved = false;
+        const auto scen_name = job.scen_name.empty() ? "-" : job.scen_name;
+        std::ostringstream record;
+        record << "job=" << k << "\tmap_file=" << job.map_name
+               << "\tscen_file=" << scen_name << "\tagents=" << job.N
+               << "\tseed=" << job.seed;
+        if (!ins.is_valid()) {
+          record << "\tsolved=0\terror=invalid_instance\n";
+        } else {
+          const auto job_deadline = Deadline(job.time_limit_ms);
+          Metrics metrics;
+          const auto solution = solve(ins, 0, &job_deadline, &MT, &metrics);
+          const auto comp_time_ms = job_deadline.elapsed_ms();
+          solved = !solution.empty() && is_feasible_solution(ins, solution);
+          auto dist_table = DistTable(ins);
+          record << "\tsolved=" << solved << "\tsoc=" << metrics.sum_of_costs
+                 << "\tsoc_lb="
+                 << get_sum_of_costs_lower_bound(ins, dist_table)
+                 << "\tmakespan=" << metrics.makespan << "\tmakespan_lb="
+                 << get_makespan_lower_bound(ins, dist_table)
+                 << "\tsum_of_loss=" << metrics.sum_of_loss
+                 << "\tcomp_time=" << comp_time_ms << "\n";
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        if (solved) ++solved_cnt;
+        os << record.str() << std::flush;
+        info(2, verbose, "elapsed:", elapsed_ms(&deadline), "ms\tjob ", k,
+             " done");
+      },
+      threads);
+
+  const auto sec = deadline.elapsed_ns() / 1e9;
+  info(1, verbose, "elapsed:", elapsed_ms(&deadline), "ms\tsolved ",
+       solved_cnt, "/", jobs.size(), "\tthroughput: ", jobs.size() / sec,
+       " instances/sec");
+  return solved_cnt;
+}
@@ -0,0 +1,228 @@
+#include "../include/config_table.hpp"
+
+#include <unistd.h>
+
+#include <cstring>
+
+ConfigTable::ConfigTable(const Graph* _G, const int _N)
+    : G(_G),
+      N(_N),
+      id_bytes(G->size() <= 0x10000 ? 2 : 4),
+      key_bytes(N * id_bytes),
+      chunks(),
+      hashes(),
+      slots(1024, -1),
+      buf(key_bytes),
+      spill_file(nullptr, &std::fclose),
+      spilled_chunks(0),
+      read_failed(false)
+{
+}
+
+int ConfigTable::size() const { return hashes.size(); }
+
+void ConfigTable::pack(const Config& C)
+{
+  if (id_bytes == 2) {
+    for (auto i = 0; i < N; ++i) {
+      const uint16_t id = C.ids[i];
+      std::memcpy(&buf[i * 2], &id, 2);
+    }
+  } else {
+    std::memcpy(buf.data(), C.ids.data(), N * 4);  // same layout
+  }
+}
+
+int ConfigTable::probe(const uint64_t hash) const
+{
+  // linear probing, one hash compare plus one memcmp per occupied slot
+  const size_t mask = slots.size() - 1;
+  auto s = hash & mask;
+  while (slots[s] != -1) {
+    const auto k = slots[s];
+    if (hashes[k] == hash && equals(k, buf.data())) break;
+    s = (s + 1) & mask;
+  }
+  return s;
+}
+
+void ConfigTable::grow()
+{
+  // rehash with the stored hash values, keeping load factor <= 0.5
+  slots.assign(slots.size() * 2, -1);
+  const size_t mask = slots.size() - 1;
+  for (size_t k = 0; k < hashes.size(); ++k) {
+    auto s = hashes[k] & mask;
+    while (slots[s] != -1) s = (s + 1) & mask;
+    slots[s] = k;
+  }
+}
+
+int ConfigTable::find(const Config& C)
+{
+  pack(C);
+  return slots[probe(ConfigHasher()(C))];
+}
+
+std::pair<int, bool> ConfigTable::insert(const Config& C)
+{
+  return insert(C, ConfigHasher()(C));
+}
+
+std::pair<int, bool> ConfigTable::insert(const Config& C, const uint64_t hash)
+{
+  pack(C);
+  const auto s = probe(hash);
+  if (slots[s] != -1) return {slots[s], false};
+
+  const int k = hashes.size();
+  slots[s] = k;
+  hashes.push_back(hash);
+  if (k % CHUNK_SIZE == 0) {
+    chunks.emplace_back();
+    chunks.back().reserve(CHUNK_SIZE * key_bytes);
+  }
+  chunks.back().insert(chunks.back().end(), buf.begin(), buf.end());
+  if (hashes.size() * 2 > slots.size()) grow();
+  return {k, true};
+}
+
+uint64_t ConfigTable::get_hash(const int k) const { return hashes[k]; }
+
+Vertex* ConfigTable::get(const int k, const int i) const
+{
+  if (id_bytes == 2) {
+    uint16_t id;
+    if (!read(k, i * 2, 2, &id)) return nullptr;
+    return G->V[id];
+  }
+  uint32_t id;
+  if (!read(k, i * 4, 4, &id)) return nullptr;
+  return G->V[id];
+}
+
+bool ConfigTable::unpack(const int k, Config& C) const
+{
+  C.resize(N);
+  C.G = G;
+  if (id_bytes == 4) return read(k, 0, key_bytes, C.ids.data());  // same layout
+
+  auto p = key(k);
+  std::vector<uint8_t> packed;
+  if (p == nullptr) {
+    packed.resize(key_bytes);
+    if (!read(k, 0, key_bytes, packed.data())) return false;
+    p = packed.data();
+  }
+  for (auto i = 0; i < N; ++i) {
+    uint16_t id;
+    std::memcpy(&id, p + i * 2, 2);
+    C.ids[i] = id;
+  }
+  return true;
+}
+
+bool ConfigTable::get_moves(const int k_from, const int k_to,
+                            std::vector<Solution::Move>& moves) const
+{
+  moves.clear();
+  const int ks[2] = {k_from, k_to};
+  const uint8_t* p[2];
+  std::vector<uint8_t> packed[2];  // for spilled ones
+  for (auto j = 0; j < 2; ++j) {
+    p[j] = key(ks[j]);
+    if (p[j] != nullptr) continue;
+    packed[j].resize(key_bytes);
+    if (!read(ks[j], 0, key_bytes, packed[j].data())) return false;
+    p[j] = packed[j].data();
+  }
+  for (auto i = 0; i < N; ++i) {
+    const auto pos = i * id_bytes;
+    if (std::memcmp(p[0] + pos, p[1] + pos, id_bytes) == 0) continue;
+    uint32_t id;
+    if (id_bytes == 2) {
+      uint16_t id16;
+      std::memcpy(&id16, p[1] + pos, 2);
+      id = id16;
+    } else {
+      std::memcpy(&id, p[1] + pos, 4);
+    }
+    moves.push_back(Solution::Move{(uint32_t)i, id});
+  }
+  return true;
+}
+
+bool ConfigTable::is_same(const int k, const Config& C)
+{
+  pack(C);
+  return equals(k, buf.data());
+}
+
+const uint8_t* ConfigTable::key(const int k) const
+{
+  const auto& chunk = chunks[k / CHUNK_SIZE];
+  if (chunk.empty()) return nullptr;
+  return &chunk[(k % CHUNK_SIZE) * key_bytes];
+}
+
+bool ConfigTable::read(const int k, const size_t pos, const size_t len,
+                       void* dst) const
+{
+  const auto p = key(k);
+  if (p != nullptr) {
+    std::memcpy(dst, p + pos, len);
+    return true;
+  }
+
+  // spilled, read back from disk, retrying short reads
+  if (read_failed) return false;
+  const auto offset = (off_t)k * key_bytes + pos;
+  auto d = (uint8_t*)dst;
+  for (size_t done = 0; done < len;) {
+    const auto r = pread(fileno(spill_file.get()), d + done, len - done,
+                         offset + done);
+    if (r <= 0) {
+      info(0, 0, "failed to read spilled configurations");
+      read_failed = true;
+      return false;
+    }
+    done += r;
+  }
+  return true;
+}
+
+bool ConfigTable::equals(const int k, const uint8_t* packed) const
+{
+  const auto p = key(k);
+  if (p != nullptr) return std::memcmp(p, packed, key_bytes) == 0;
+  std::vector<uint8_t> spilled(key_bytes);
+  return read(k, 0, key_bytes, spilled.data()) &&
+         std::memcmp(spilled.data(), packed, key_bytes) == 0;
+}
+
+size_t ConfigTable::bytes() const
+{
+  return (chunks.size() - spilled_chunks) * CHUNK_SIZE * key_bytes +
+         hashes.capacity() * sizeof(uint64_t) + slots.size() * sizeof(int);
+}
+
+size_t ConfigTable::spill(const size_t target)
+{
+  if (spill_file == nullptr) spill_file.reset(std::tmpfile());
+  if (spill_file == nullptr) return 0;
+
+  // the last chunk is still filled
+  size_t freed = 0;
+  for (size_t c = spilled_chunks; c + 1 < chunks.size() && freed < target;
+       ++c) {
+    auto& chunk = chunks[c];
+    const auto offset = (off_t)c * CHUNK_SIZE * key_bytes;
+    if (pwrite(fileno(spill_file.get()), chunk.data(), chunk.size(),
+               offset) != (ssize_t)chunk.size())
+      break;
+    freed += chunk.capacity();
+    std::vector<uint8_t>().swap(chunk);
+    ++spilled_chunks;
+  }
+  return freed;
+}
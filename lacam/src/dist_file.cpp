@@ -0,0 +1,143 @@
+#include "../include/dist_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+
+#include "../include/dist_table.hpp"
+
+constexpr char DistFile::MAGIC[8];
+constexpr uint32_t DistFile::VERSION;
+
+DistFile::DistFile(const std::string& _filename)
+    : filename(_filename),
+      data(nullptr),
+      size(0),
+      header(nullptr),
+      goals(nullptr),
+      fields(nullptr)
+{
+  const auto fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    info(0, 0, "file ", filename, " is not found.");
+    return;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(DistFileHeader)) {
+    size = st.st_size;
+    // shared read-only pages, reused by other processes
+    data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) data = nullptr;
+  }
+  close(fd);
+  if (data == nullptr) {
+    info(0, 0, "failed to map ", filename);
+    return;
+  }
+
+  header = (const DistFileHeader*)data;
+  const size_t K = header->num_vertices;
+  const size_t n = header->num_goals;
+  // sizes are divided, not multiplied, to be safe against overflow
+  const size_t rest = size - sizeof(DistFileHeader);
+  const size_t field_bytes = K * header->dist_bytes;  // K < 2^32
+  auto is_consistent = [&]() {
+    if (n > rest / sizeof(uint32_t)) return false;
+    const auto rest_fields = rest - n * sizeof(uint32_t);
+    if (field_bytes == 0) return rest_fields == 0;
+    return rest_fields % field_bytes == 0 && rest_fields / field_bytes == n;
+  };
+  if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header->version != VERSION || header->dist_bytes != get_dist_bytes(K) ||
+      !is_consistent()) {
+    info(0, 0, filename, " is not a valid distance file");
+    munmap(data, size);
+    data = nullptr;
+    return;
+  }
+  goals = (const uint32_t*)(header + 1);
+  fields = (const uint8_t*)(goals + n);
+  for (size_t k = 0; k < n; ++k) index[goals[k]] = k;
+}
+
+DistFile::~DistFile()
+{
+  if (data != nullptr) munmap(data, size);
+}
+
+bool DistFile::is_valid() const { return data != nullptr; }
+
+const void* DistFile::get(const uint64_t map_hash, const int goal_id) const
+{
+  if (data == nullptr || header->map_hash != map_hash) return nullptr;
+  auto iter = index.find(goal_id);
+  if (iter == index.end()) return nullptr;
+  return fields + (size_t)iter->second * header->num_vertices *
+                      header->dist_bytes;
+}
+
+bool write_dist_file(const std::string& filename, const Graph& G,
+                     const Vertices& goals)
+{
+  const size_t K = G.size();
+  const size_t B = get_dist_bytes(K);
+
+  auto header = DistFileHeader();
+  std::memcpy(header.magic, DistFile::MAGIC, sizeof(DistFile::MAGIC));
+  header.version = DistFile::VERSION;
+  header.num_vertices = K;
+  header.map_hash = G.hash;
+  header.dist_bytes = B;
+
+  // distinct goals
+  std::vector<bool> used(K, false);
+  Vertices targets;
+  std::vector<uint32_t> goal_ids;
+  for (auto g : goals) {
+    if (used[g->id]) continue;
+    used[g->id] = true;
+    targets.push_back(g);
+    goal_ids.push_back(g->id);
+  }
+  header.num_goals = targets.size();
+
+  const auto fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    info(0, 0, "failed to open ", filename);
+    return false;
+  }
+  auto write_at = [&](const void* buf, size_t bytes, off_t offset) {
+    for (size_t done = 0; done < bytes;) {
+      const auto r = pwrite(fd, (const char*)buf + done, bytes - done,
+                            offset + done);
+      if (r <= 0) return false;
+      done += r;
+    }
+    return true;
+  };
+  bool ok = write_at(&header, sizeof(header), 0) &&
+            write_at(goal_ids.data(), goal_ids.size() * sizeof(uint32_t),
+                     sizeof(header));
+
+  // each field is written at its offset once computed
+  // memory is one field per worker, not all of them
+  const off_t fields_offset =
+      sizeof(header) + goal_ids.size() * sizeof(uint32_t);
+  std::atomic<bool> failed(!ok);
+  parallel_for(targets.size(), [&](size_t k) {
+    if (failed.load()) return;
+    std::vector<uint8_t> field(K * B);
+    fill_dist_field(G, targets[k], (void*)field.data());
+    if (!write_at(field.data(), field.size(), fields_offset + k * K * B)) {
+      failed = true;
+    }
+  });
+  ok = !failed.load();
+  if (close(fd) != 0) ok = false;
+  if (!ok) info(0, 0, "failed to write ", filename);
+  return ok;
+}
@@ -1,50 +1,294 @@
 #include "../include/dist_table.hpp"
 
-DistTable::DistTable(const Instance& ins)
-    : K(ins.G.V.size()), table(ins.N, std::vector<int>(K, K))
+#include "../include/profile.hpp"
+
+template <typename T>
+void fill_dist_field(const Graph& G, Vertex* goal, T* field)
+{
+  const int K = G.size();
+  std::fill(field, field + K, K);
+
+  // BFS on CSR, each vertex is enqueued at most once
+  std::vector<int> Q(K);
+  size_t head = 0, tail = 0;
+  Q[tail++] = goal->id;
+  field[goal->id] = 0;
+  while (head < tail) {
+    const auto n = Q[head++];
+    const T d_m = field[n] + 1;
+    for (auto k = G.adj_offsets[n]; k < G.adj_offsets[n + 1]; ++k) {
+      const auto m = G.adj[k];
+      if (d_m >= field[m]) continue;
+      field[m] = d_m;
+      Q[tail++] = m;
+    }
+  }
+  PROFILE_ADD(BFS_EXPANSIONS, tail);
+}
+template void fill_dist_field(const Graph&, Vertex*, uint16_t*);
+template void fill_dist_field(const Graph&, Vertex*, uint32_t*);
+
+void fill_dist_field(const Graph& G, Vertex* goal, void* field)
+{
+  if (get_dist_bytes(G.size()) == 4) {
+    fill_dist_field(G, goal, (uint32_t*)field);
+  } else {
+    fill_dist_field(G, goal, (uint16_t*)field);
+  }
+}
+
+size_t DistCache::KeyHasher::operator()(const Key& k) const
 {
-  setup(&ins);
+  return k.first ^ ((uint64_t)k.second * 0x9e3779b97f4a7c15);
 }
 
-DistTable::DistTable(const Instance* ins)
-    : K(ins->G.V.size()), table(ins->N, std::vector<int>(K, K))
+DistCache& DistCache::get_instance()
+{
+  static DistCache cache;
+  return cache;
+}
+
+DistCache::DistCache(const size_t _budget)
+    : budget(_budget), bytes(0), hit(0), miss(0)
+{
+}
+
+bool DistCache::enabled() const
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  return budget > 0 || !files.empty();
+}
+
+void DistCache::set_budget(const size_t _budget)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  budget = _budget;
+  evict(budget);
+}
+
+void DistCache::evict(const size_t limit)
+{
+  // fields still referred by DistTable are freed when released
+  while (bytes > limit && !lru.empty()) {
+    auto iter = fields.find(lru.back());
+    bytes -= iter->second.bytes;
+    fields.erase(iter);
+    lru.pop_back();
+  }
+}
+
+void DistCache::attach(std::shared_ptr<const DistFile> file)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  files.push_back(file);
+}
+
+void DistCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  files.clear();
+  fields.clear();
+  lru.clear();
+  bytes = 0;
+  hit = 0;
+  miss = 0;
+}
+
+std::shared_ptr<const void> DistCache::get(const Graph& G, Vertex* goal)
+{
+  const auto key = Key(G.hash, goal->id);
+  const size_t field_bytes = G.size() * get_dist_bytes(G.size());
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto iter = fields.find(key);
+    if (iter != fields.end()) {
+      ++hit;
+      lru.splice(lru.begin(), lru, iter->second.pos);
+      return iter->second.field;
+    }
+    for (auto& file : files) {
+      auto field = file->get(G.hash, goal->id);
+      if (field == nullptr || (int)file->header->num_vertices != G.size()) {
+        continue;
+      }
+      ++hit;
+      return std::shared_ptr<const void>(file, field);  // keep file alive
+    }
+    ++miss;
+  }
+
+  // BFS outside of the lock
+  auto vec = std::make_shared<std::vector<uint8_t> >(field_bytes);
+  fill_dist_field(G, goal, (void*)vec->data());
+  auto field = std::shared_ptr<const void>(vec, vec->data());
+
+  std::lock_guard<std::mutex> lock(mtx);
+  if (fields.find(key) != fields.end()) return fields[key].field;
+  if (field_bytes > budget) return field;  // not cached
+  evict(budget - field_bytes);
+  lru.push_front(key);
+  fields[key] = Entry{field, field_bytes, lru.begin()};
+  bytes += field_bytes;
+  return field;
+}
+
+bool DistTable::FLG_EAGER = false;
+
+DistTable::DistTable(const Instance& ins, const bool _eager)
+    : DistTable(&ins, _eager)
+{
+}
+
+DistTable::DistTable(const Instance* ins, const bool _eager)
+    : G(&ins->G),
+      K(ins->G.V.size()),
+      eager(_eager || DistCache::get_instance().enabled()),
+      wide(get_dist_bytes(K) == 4)
 {
   setup(ins);
 }
 
+void DistTable::set_row(int i, const void* row)
+{
+  if (wide) {
+    rows32[i] = (const uint32_t*)row;
+  } else {
+    rows[i] = (const uint16_t*)row;
+  }
+}
+
 void DistTable::setup(const Instance* ins)
 {
-  for (size_t i = 0; i < ins->N; ++i) {
-    OPEN.push_back(std::queue<Vertex*>());
-    auto n = ins->goals[i];
-    OPEN[i].push(n);
-    table[i][n->id] = 0;
+  const size_t N = ins->N;
+  if (wide) {
+    rows32.resize(N);
+  } else {
+    rows.resize(N);
+  }
+
+  if (!eager) {
+    // one row per agent, filled by BFS on demand
+    if (wide) {
+      dists32.resize(N * K);
+    } else {
+      dists.resize(N * K);
+    }
+    OPEN.resize(N);
+    for (size_t i = 0; i < N; ++i) {
+      set_goal(i, ins->goals[i]);
+    }
+    return;
+  }
+
+  // deduplicate goals, agents sharing a goal share a row
+  std::vector<int> row_of_goal(K, -1);
+  Vertices goals;
+  for (auto g : ins->goals) {
+    if (row_of_goal[g->id] != -1) continue;
+    row_of_goal[g->id] = goals.size();
+    goals.push_back(g);
+  }
+
+  // consult the shared cache
+  auto& cache = DistCache::get_instance();
+  if (cache.enabled()) {
+    fields.resize(goals.size());
+    parallel_for(goals.size(), [&](size_t r) {
+      fields[r] = cache.get(ins->G, goals[r]);
+    });
+    for (size_t i = 0; i < N; ++i) {
+      set_row(i, fields[row_of_goal[ins->goals[i]->id]].get());
+    }
+    return;
+  }
+
+  // full BFS for each distinct goal
+  if (wide) {
+    dists32.resize(goals.size() * K);
+  } else {
+    dists.resize(goals.size() * K);
+  }
+  parallel_for(goals.size(), [&](size_t r) {
+    if (wide) {
+      fill_dist_field(ins->G, goals[r], dists32.data() + r * K);
+    } else {
+      fill_dist_field(ins->G, goals[r], dists.data() + r * K);
+    }
+  });
+  for (size_t i = 0; i < N; ++i) {
+    const size_t r = row_of_goal[ins->goals[i]->id];
+    if (wide) {
+      rows32[i] = dists32.data() + r * K;
+    } else {
+      rows[i] = dists.data() + r * K;
+    }
+  }
+}
+
+void DistTable::set_goal(int i, Vertex* goal)
+{
+  if (!eager) {
+    if (wide) {
+      rows32[i] = dists32.data() + (size_t)i * K;
+      std::fill(dists32.begin() + (size_t)i * K,
+                dists32.begin() + (size_t)(i + 1) * K, K);
+      dists32[(size_t)i * K + goal->id] = 0;
+    } else {
+      rows[i] = dists.data() + (size_t)i * K;
+      std::fill(dists.begin() + (size_t)i * K,
+                dists.begin() + (size_t)(i + 1) * K, K);
+      dists[(size_t)i * K + goal->id] = 0;
+    }
+    OPEN[i] = std::queue<int>();
+    OPEN[i].push(goal->id);
+    return;
+  }
+
+  // other rows are untouched, possibly shared among agents
+  if (updated.empty()) updated.resize(wide ? rows32.size() : rows.size());
+  auto& cache = DistCache::get_instance();
+  if (cache.enabled()) {
+    updated[i] = cache.get(*G, goal);
+  } else {
+    auto vec = std::make_shared<std::vector<uint8_t> >(K * get_dist_bytes(K));
+    fill_dist_field(*G, goal, (void*)vec->data());
+    updated[i] = std::shared_ptr<const void>(vec, vec->data());
+  }
+  set_row(i, updated[i].get());
+}
+
+// BFS with lazy evaluation on the owned row of agent-i
+template <typename T>
+static int lazy_bfs(const Graph* G, std::queue<int>& OPEN, T* row,
+                    const int v_id)
+{
+  const int K = G->size();
+  PROFILE_TIMER(TIME_BFS_NS);
+  while (!OPEN.empty()) {
+    auto n = OPEN.front();
+    OPEN.pop();
+    PROFILE_COUNT(BFS_EXPANSIONS);
+    const int d_n = row[n];
+    for (auto k = G->adj_offsets[n]; k < G->adj_offsets[n + 1]; ++k) {
+      const auto m = G->adj[k];
+      if (d_n + 1 >= (int)row[m]) continue;
+      row[m] = d_n + 1;
+      OPEN.push(m);
+    }
+    if (n == v_id) return d_n;
   }
+  return K;
 }
 
-int DistTable::get(int i, int v_id)
+int DistTable::get_lazy(int i, int v_id)
 {
-  if (table[i][v_id] < K) return table[i][v_id];
+  if (eager) return K;  // unreachable
 
   /*
    * BFS with lazy evaluation
    * c.f., Reverse Resumable A*
    * https://www.aaai.org/Papers/AIIDE/2005/AIIDE05-020.pdf
    */
-
-  while (!OPEN[i].empty()) {
-    auto n = OPEN[i].front();
-    OPEN[i].pop();
-    const int d_n = table[i][n->id];
-    for (auto& m : n->neighbor) {
-      const int d_m = table[i][m->id];
-      if (d_n + 1 >= d_m) continue;
-      table[i][m->id] = d_n + 1;
-      OPEN[i].push(m);
-    }
-    if (n->id == v_id) return d_n;
-  }
-  return K;
+  if (wide) return lazy_bfs(G, OPEN[i], dists32.data() + (size_t)i * K, v_id);
+  return lazy_bfs(G, OPEN[i], dists.data() + (size_t)i * K, v_id);
 }
-
-int DistTable::get(int i, Vertex* v) { return get(i, v->id); }
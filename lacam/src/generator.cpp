@@ -0,0 +1,215 @@
+#include "../include/generator.hpp"
+
+GridMap::GridMap(int _width, int _height, char c)
+    : width(_width), height(_height), cells((size_t)_width * _height, c)
+{
+}
+
+bool GridMap::is_free(int x, int y) const
+{
+  return 0 <= x && x < width && 0 <= y && y < height &&
+         cells[(size_t)y * width + x] == '.';
+}
+
+void GridMap::set(int x, int y, char c)
+{
+  if (0 <= x && x < width && 0 <= y && y < height) {
+    cells[(size_t)y * width + x] = c;
+  }
+}
+
+int GridMap::count_free() const
+{
+  return std::count(cells.begin(), cells.end(), '.');
+}
+
+void GridMap::keep_largest_component()
+{
+  // BFS labeling, 4-connected
+  const int K = cells.size();
+  std::vector<int> label(K, -1);
+  std::vector<int> Q(K);
+  int best_label = -1, best_size = 0;
+  for (auto s = 0; s < K; ++s) {
+    if (cells[s] != '.' || label[s] != -1) continue;
+    size_t head = 0, tail = 0;
+    Q[tail++] = s;
+    label[s] = s;
+    while (head < tail) {
+      const auto n = Q[head++];
+      const int x = n % width, y = n / width;
+      const int dx[4] = {1, -1, 0, 0};
+      const int dy[4] = {0, 0, 1, -1};
+      for (auto k = 0; k < 4; ++k) {
+        if (!is_free(x + dx[k], y + dy[k])) continue;
+        const auto m = (y + dy[k]) * width + x + dx[k];
+        if (label[m] != -1) continue;
+        label[m] = s;
+        Q[tail++] = m;
+      }
+    }
+    if ((int)tail > best_size) {
+      best_size = tail;
+      best_label = s;
+    }
+  }
+  for (auto k = 0; k < K; ++k) {
+    if (cells[k] == '.' && label[k] != best_label) cells[k] = '@';
+  }
+}
+
+bool GridMap::save(const std::string& filename) const
+{
+  std::ofstream file(filename, std::ios::out);
+  if (!file) {
+    info(0, 0, "failed to open ", filename);
+    return false;
+  }
+  file << "type octile\nheight " << height << "\nwidth " << width
+       << "\nmap\n";
+  for (auto y = 0; y < height; ++y) {
+    file.write(cells.data() + (size_t)y * width, width);
+    file << "\n";
+  }
+  return file.good();
+}
+
+GridMap make_random_map(int width, int height, float obstacle_ratio,
+                        std::mt19937* MT)
+{
+  auto map = GridMap(width, height);
+  for (auto& c : map.cells) {
+    if (get_random_float(MT) < obstacle_ratio) c = '@';
+  }
+  map.keep_largest_component();
+  return map;
+}
+
+GridMap make_warehouse_map(int width, int height, int shelf_width,
+                           int shelf_height, int aisle)
+{
+  auto map = GridMap(width, height);
+  for (auto y = aisle; y + shelf_height <= height - aisle;
+       y += shelf_height + aisle) {
+    for (auto x = aisle; x + shelf_width <= width - aisle;
+         x += shelf_width + aisle) {
+      for (auto dy = 0; dy < shelf_height; ++dy) {
+        for (auto dx = 0; dx < shelf_width; ++dx) map.set(x + dx, y + dy, '@');
+      }
+    }
+  }
+  return map;
+}
+
+GridMap make_maze_map(int width, int height, int corridor, float loop_ratio,
+                      std::mt19937* MT)
+{
+  // cells of corridor x corridor, separated by walls of one
+  auto map = GridMap(width, height, '@');
+  const int unit = corridor + 1;
+  const int cw = std::max(1, (width - 1) / unit);
+  const int ch = std::max(1, (height - 1) / unit);
+  auto carve = [&](int x0, int y0, int w, int h) {
+    for (auto y = y0; y < y0 + h; ++y) {
+      for (auto x = x0; x < x0 + w; ++x) map.set(x, y, '.');
+    }
+  };
+  // open the wall between cell c and its right (dir=0) or lower (dir=1) one
+  auto open = [&](int c, int dir) {
+    const int x0 = 1 + (c % cw) * unit, y0 = 1 + (c / cw) * unit;
+    if (dir == 0) {
+      carve(x0 + corridor, y0, 1, corridor);
+    } else {
+      carve(x0, y0 + corridor, corridor, 1);
+    }
+  };
+  for (auto c = 0; c < cw * ch; ++c) {
+    carve(1 + (c % cw) * unit, 1 + (c / cw) * unit, corridor, corridor);
+  }
+
+  // randomized DFS, with an explicit stack
+  std::vector<bool> visited(cw * ch, false);
+  std::vector<int> stack = {0};
+  visited[0] = true;
+  while (!stack.empty()) {
+    const auto c = stack.back();
+    const int cx = c % cw, cy = c / cw;
+    std::array<int, 4> nbrs;
+    int K = 0;
+    if (cx + 1 < cw && !visited[c + 1]) nbrs[K++] = c + 1;
+    if (cx > 0 && !visited[c - 1]) nbrs[K++] = c - 1;
+    if (cy + 1 < ch && !visited[c + cw]) nbrs[K++] = c + cw;
+    if (cy > 0 && !visited[c - cw]) nbrs[K++] = c - cw;
+    if (K == 0) {
+      stack.pop_back();
+      continue;
+    }
+    const auto n = nbrs[get_random_int(MT, 0, K - 1)];
+    if (n == c + 1) open(c, 0);
+    if (n == c - 1) open(n, 0);
+    if (n == c + cw) open(c, 1);
+    if (n == c - cw) open(n, 1);
+    visited[n] = true;
+    stack.push_back(n);
+  }
+
+  // loops, otherwise agents cannot pass each other
+  for (auto c = 0; c < cw * ch; ++c) {
+    if (c % cw + 1 < cw && get_random_float(MT) < loop_ratio) open(c, 0);
+    if (c / cw + 1 < ch && get_random_float(MT) < loop_ratio) open(c, 1);
+  }
+  return map;
+}
+
+GridMap make_room_map(int width, int height, int room_size, std::mt19937* MT)
+{
+  auto map = GridMap(width, height);
+  const int unit = room_size + 1;
+  for (auto y = 0; y < height; ++y) {
+    for (auto x = 0; x < width; ++x) {
+      if (x % unit == room_size || y % unit == room_size) map.set(x, y, '@');
+    }
+  }
+  // one door on each wall segment between two rooms
+  for (auto ry = 0; ry * unit < height; ++ry) {
+    for (auto rx = 0; rx * unit < width; ++rx) {
+      const int x0 = rx * unit, y0 = ry * unit;
+      const int w = std::min(room_size, width - x0);
+      const int h = std::min(room_size, height - y0);
+      if (x0 + room_size + 1 < width && h > 0) {
+        map.set(x0 + room_size, y0 + get_random_int(MT, 0, h - 1), '.');
+      }
+      if (y0 + room_size + 1 < height && w > 0) {
+        map.set(x0 + get_random_int(MT, 0, w - 1), y0 + room_size, '.');
+      }
+    }
+  }
+  map.keep_largest_component();
+  return map;
+}
+
+bool save_scen(const std::string& filename, const std::string& map_name,
+               const Instance& ins)
+{
+  std::ofstream file(filename, std::ios::out);
+  if (!file) {
+    info(0, 0, "failed to open ", filename);
+    return false;
+  }
+  // map name, without directories
+  const auto k = map_name.find_last_of('/');
+  const auto map_recorded_name =
+      k == std::string::npos ? map_name : map_name.substr(k + 1);
+  const int width = ins.G.width;
+  std::string buf = "version 1\n";
+  for (size_t i = 0; i < ins.N; ++i) {
+    const auto s = ins.starts[i]->index, g = ins.goals[i]->index;
+    buf += std::to_string(i / 10) + "\t" + map_recorded_name + "\t" +
+           std::to_string(width) + "\t" + std::to_string(ins.G.height) +
+           "\t" + std::to_string(s % width) + "\t" +
+           std::to_string(s / width) + "\t" + std::to_string(g % width) +
+           "\t" + std::to_string(g / width) + "\t0\n";
+  }
+  file << buf;
+  return file.good();
+}
@@ -1,71 +1,81 @@
 #include "../include/graph.hpp"
 
-Vertex::Vertex(int _id, int _index)
-    : id(_id), index(_index), neighbor(Vertices())
+#include <cctype>
+
+Vertex::Vertex(int _id, int _index, const Graph* _G)
+    : id(_id), index(_index), neighbor(Vertices()), G(_G)
 {
 }
 
-Graph::Graph() : V(Vertices()), width(0), height(0) {}
-Graph::~Graph()
+Graph::Graph() : V(Vertices()), width(0), height(0), hash(0) {}
+Graph::~Graph() {}
+
+// to load graph, e.g., "height 32"
+static bool parse_header(std::string_view line, std::string_view key,
+                         int& value)
 {
-  for (auto& v : V)
-    if (v != nullptr) delete v;
-  V.clear();
+  if (line.size() <= key.size() + 1 || line.substr(0, key.size()) != key ||
+      !std::isspace(line[key.size()]))
+    return false;
+  return parse_uint(line.substr(key.size() + 1), value);
 }
 
-// to load graph
-static const std::regex r_height = std::regex(R"(height\s(\d+))");
-static const std::regex r_width = std::regex(R"(width\s(\d+))");
-static const std::regex r_map = std::regex(R"(map)");
-
-Graph::Graph(const std::string& filename) : V(Vertices()), width(0), height(0)
+Graph::Graph(const std::string& filename)
+    : V(Vertices()), width(0), height(0), hash(0)
 {
-  std::ifstream file(filename);
-  if (!file) {
+  std::string buf;
+  if (!read_file(filename, buf)) {
     std::cout << "file " << filename << " is not found." << std::endl;
     return;
   }
-  std::string line;
-  std::smatch results;
+  size_t pos = 0;
+  std::string_view line;
 
   // read fundamental graph parameters
-  while (getline(file, line)) {
-    // for CRLF coding
-    if (*(line.end() - 1) == 0x0d) line.pop_back();
-
-    if (std::regex_match(line, results, r_height)) {
-      height = std::stoi(results[1].str());
-    }
-    if (std::regex_match(line, results, r_width)) {
-      width = std::stoi(results[1].str());
-    }
-    if (std::regex_match(line, results, r_map)) break;
+  while (next_line(buf, pos, line)) {
+    parse_header(line, "height", height);
+    parse_header(line, "width", width);
+    if (line == "map") break;
   }
 
   U = Vertices(width * height, nullptr);
 
-  // create vertices
+  // passable cells, stored contiguously
+  std::vector<int> indexes;
   int y = 0;
-  while (getline(file, line)) {
-    // for CRLF coding
-    if (*(line.end() - 1) == 0x0d) line.pop_back();
-    for (int x = 0; x < width; ++x) {
+  while (y < height && next_line(buf, pos, line)) {
+    const int w = std::min(width, (int)line.size());
+    for (int x = 0; x < w; ++x) {
       char s = line[x];
       if (s == 'T' or s == '@') continue;  // object
-      auto index = width * y + x;
-      auto v = new Vertex(V.size(), index);
-      V.push_back(v);
-      U[index] = v;
+      indexes.push_back(width * y + x);
     }
     ++y;
   }
-  file.close();
+
+  // create vertices, no reallocation after reserve
+  vertices.reserve(indexes.size());
+  for (auto index : indexes) {
+    vertices.emplace_back(vertices.size(), index, this);
+  }
+  for (auto& v : vertices) {
+    V.push_back(&v);
+    U[v.index] = &v;
+  }
+
+  // content hash, FNV-1a over the size and passable cells
+  hash = 0xcbf29ce484222325;
+  auto fnv = [&](uint64_t x) { hash = (hash ^ x) * 0x100000001b3; };
+  fnv(width);
+  fnv(height);
+  for (auto v : V) fnv(v->index);
 
   // create edges
   for (int y = 0; y < height; ++y) {
     for (int x = 0; x < width; ++x) {
       auto v = U[width * y + x];
       if (v == nullptr) continue;
+      v->neighbor.reserve(4);  // avoid reallocation
       // left
       if (x > 0) {
         auto u = U[width * y + (x - 1)];
@@ -88,25 +98,41 @@ Graph::Graph(const std::string& filename) : V(Vertices()), width(0), height(0)
       }
     }
   }
+
+  // flatten edges, vertex-ids follow row-major order of the grid
+  adj_offsets.push_back(0);
+  for (auto v : V) {
+    for (auto u : v->neighbor) adj.push_back(u->id);
+    adj_offsets.push_back(adj.size());
+  }
 }
 
 int Graph::size() const { return V.size(); }
 
 bool is_same_config(const Config& C1, const Config& C2)
 {
-  const auto N = C1.size();
-  for (size_t i = 0; i < N; ++i) {
-    if (C1[i]->id != C2[i]->id) return false;
-  }
-  return true;
+  return C1.ids == C2.ids;
 }
 
-uint ConfigHasher::operator()(const Config& C) const
+uint64_t ConfigHasher::key(const int i, const int v_id)
 {
-  uint hash = C.size();
-  for (auto& v : C) {
-    hash ^= v->id + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-  }
+  // splitmix64
+  uint64_t z = ((uint64_t)i << 32 | (uint32_t)v_id) + 0x9e3779b97f4a7c15;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+uint64_t ConfigHasher::update(const uint64_t hash, const int i,
+                              Vertex* v_from, Vertex* v_to)
+{
+  return hash ^ key(i, v_from->id) ^ key(i, v_to->id);
+}
+
+uint64_t ConfigHasher::operator()(const Config& C) const
+{
+  uint64_t hash = 0;
+  for (size_t i = 0; i < C.size(); ++i) hash ^= key(i, C.ids[i]);
   return hash;
 }
 
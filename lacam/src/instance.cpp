@@ -3,7 +3,8 @@
 Instance::Instance(const std::string& map_filename,
                    const std::vector<int>& start_indexes,
                    const std::vector<int>& goal_indexes)
-    : G(map_filename),
+    : G_ptr(std::make_shared<const Graph>(map_filename)),
+      G(*G_ptr),
       starts(Config()),
       goals(Config()),
       N(start_indexes.size())
@@ -12,74 +13,97 @@ Instance::Instance(const std::string& map_filename,
   for (auto k : goal_indexes) goals.push_back(G.U[k]);
 }
 
-// for load instance
-static const std::regex r_instance =
-    std::regex(R"(\d+\t.+\.map\t\d+\t\d+\t(\d+)\t(\d+)\t(\d+)\t(\d+)\t.+)");
+// for load instance, a line of MAPF benchmark
+// bucket \t map \t width \t height \t x_s \t y_s \t x_g \t y_g \t optimal
+static bool parse_scen_line(std::string_view line, int& x_s, int& y_s,
+                            int& x_g, int& y_g)
+{
+  std::string_view cols[9];
+  for (int k = 0; k < 8; ++k) {
+    const auto end = line.find('\t');
+    if (end == std::string_view::npos) return false;
+    cols[k] = line.substr(0, end);
+    line.remove_prefix(end + 1);
+  }
+  cols[8] = line;
+  int tmp;
+  return parse_uint(cols[0], tmp) && cols[1].size() > 4 &&
+         cols[1].substr(cols[1].size() - 4) == ".map" &&
+         parse_uint(cols[2], tmp) && parse_uint(cols[3], tmp) &&
+         parse_uint(cols[4], x_s) && parse_uint(cols[5], y_s) &&
+         parse_uint(cols[6], x_g) && parse_uint(cols[7], y_g) &&
+         !cols[8].empty();
+}
 
 Instance::Instance(const std::string& scen_filename,
                    const std::string& map_filename, const int _N)
-    : G(Graph(map_filename)), starts(Config()), goals(Config()), N(_N)
+    : Instance(scen_filename, std::make_shared<const Graph>(map_filename), _N)
+{
+}
+
+Instance::Instance(const std::string& scen_filename,
+                   std::shared_ptr<const Graph> _G, const int _N)
+    : G_ptr(_G), G(*G_ptr), starts(Config()), goals(Config()), N(_N)
 {
   // load start-goal pairs
-  std::ifstream file(scen_filename);
-  if (!file) {
+  std::string buf;
+  if (!read_file(scen_filename, buf)) {
     info(0, 0, scen_filename, " is not found");
     return;
   }
-  std::string line;
-  std::smatch results;
-
-  while (getline(file, line)) {
-    // for CRLF coding
-    if (*(line.end() - 1) == 0x0d) line.pop_back();
+  size_t pos = 0;
+  std::string_view line;
+  int x_s, y_s, x_g, y_g;
 
-    if (std::regex_match(line, results, r_instance)) {
-      auto x_s = std::stoi(results[1].str());
-      auto y_s = std::stoi(results[2].str());
-      auto x_g = std::stoi(results[3].str());
-      auto y_g = std::stoi(results[4].str());
-      if (x_s < 0 || G.width <= x_s || x_g < 0 || G.width <= x_g) continue;
-      if (y_s < 0 || G.height <= y_s || y_g < 0 || G.height <= y_g) continue;
-      auto s = G.U[G.width * y_s + x_s];
-      auto g = G.U[G.width * y_g + x_g];
-      if (s == nullptr || g == nullptr) continue;
-      starts.push_back(s);
-      goals.push_back(g);
-    }
+  while (starts.size() < N && next_line(buf, pos, line)) {
+    if (!parse_scen_line(line, x_s, y_s, x_g, y_g)) continue;
+    if (x_s < 0 || G.width <= x_s || x_g < 0 || G.width <= x_g) continue;
+    if (y_s < 0 || G.height <= y_s || y_g < 0 || G.height <= y_g) continue;
+    auto s = G.U[G.width * y_s + x_s];
+    auto g = G.U[G.width * y_g + x_g];
+    if (s == nullptr || g == nullptr) continue;
+    starts.push_back(s);
+    goals.push_back(g);
+  }
+}
 
-    if (starts.size() == N) break;
+// n distinct indexes in [0, K), partial Fisher-Yates on a sparse array
+// O(n) instead of shuffling all K indexes
+static std::vector<int> sample_indexes(const int K, const int n,
+                                       std::mt19937* MT)
+{
+  std::unordered_map<int, int> swapped;  // index -> value, others identity
+  auto get = [&](int k) {
+    auto it = swapped.find(k);
+    return it == swapped.end() ? k : it->second;
+  };
+  swapped.reserve(n);
+  std::vector<int> res(n);
+  for (auto i = 0; i < n; ++i) {
+    const auto j = get_random_int(MT, i, K - 1);
+    res[i] = get(j);
+    swapped[j] = get(i);
   }
+  return res;
 }
 
 Instance::Instance(const std::string& map_filename, std::mt19937* MT,
                    const int _N)
-    : G(Graph(map_filename)), starts(Config()), goals(Config()), N(_N)
+    : Instance(std::make_shared<const Graph>(map_filename), MT, _N)
 {
-  // random assignment
-  const auto K = G.size();
+}
 
-  // set starts
-  auto s_indexes = std::vector<int>(K);
-  std::iota(s_indexes.begin(), s_indexes.end(), 0);
-  std::shuffle(s_indexes.begin(), s_indexes.end(), *MT);
-  int i = 0;
-  while (true) {
-    if (i >= K) return;
-    starts.push_back(G.V[s_indexes[i]]);
-    if (starts.size() == N) break;
-    ++i;
+Instance::Instance(std::shared_ptr<const Graph> _G, std::mt19937* MT,
+                   const int _N)
+    : G_ptr(_G), G(*G_ptr), starts(Config()), goals(Config()), N(_N)
+{
+  // random assignment, invalid when N exceeds |V|
+  const int K = G.size();
+  for (auto k : sample_indexes(K, std::min<int>(N, K), MT)) {
+    starts.push_back(G.V[k]);
   }
-
-  // set goals
-  auto g_indexes = std::vector<int>(K);
-  std::iota(g_indexes.begin(), g_indexes.end(), 0);
-  std::shuffle(g_indexes.begin(), g_indexes.end(), *MT);
-  int j = 0;
-  while (true) {
-    if (j >= K) return;
-    goals.push_back(G.V[g_indexes[j]]);
-    if (goals.size() == N) break;
-    ++j;
+  for (auto k : sample_indexes(K, std::min<int>(N, K), MT)) {
+    goals.push_back(G.V[k]);
   }
 }
 
@@ -0,0 +1,64 @@
+#include "../include/lifelong.hpp"
+
+LifelongPlanner::LifelongPlanner(const Instance& _ins, std::mt19937* MT)
+    : ins(_ins),
+      D(ins, true),
+      planner(&ins, nullptr, MT, 0, &D),
+      priorities(ins.N, 0),
+      order(ins.N, 0),
+      root()
+{
+  for (size_t i = 0; i < ins.N; ++i) {
+    priorities[i] = (float)D.get(i, ins.starts[i]) / ins.N;
+  }
+}
+
+const Config& LifelongPlanner::get_config() const { return ins.starts; }
+
+void LifelongPlanner::set_goal(const int i, Vertex* v)
+{
+  if (ins.goals[i] == v) return;
+  ins.goals[i] = v;
+  D.set_goal(i, v);
+}
+
+std::vector<Config> LifelongPlanner::plan(const int k)
+{
+  std::vector<Config> configs;
+  for (auto t = 0; t < k; ++t) {
+    advance();
+    configs.push_back(ins.starts);
+  }
+  return configs;
+}
+
+const Config& LifelongPlanner::step(const Config& C, const Config& goals)
+{
+  for (size_t i = 0; i < ins.N; ++i) set_goal(i, goals[i]);
+  if (&C != &ins.starts) ins.starts = C;  // same size, no reallocation
+  advance();
+  return ins.starts;
+}
+
+void LifelongPlanner::advance()
+{
+  const auto N = ins.N;
+
+  // PIBT, agents in order of priorities
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](int i, int j) { return priorities[i] > priorities[j]; });
+  // stay all, in case of failure
+  if (planner.get_new_config(ins.starts, order, &root)) {
+    for (auto a : planner.A) ins.starts[a->id] = a->v_next;
+  }
+
+  // dynamic priorities, same as Node
+  for (size_t i = 0; i < N; ++i) {
+    if (D.get(i, ins.starts[i]) != 0) {
+      priorities[i] += 1;
+    } else {
+      priorities[i] -= (int)priorities[i];
+    }
+  }
+}
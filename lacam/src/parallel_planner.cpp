@@ -0,0 +1,256 @@
+#include "../include/parallel_planner.hpp"
+
+#include <condition_variable>
+
+#include "../include/profile.hpp"
+
+SharedClosed::SharedClosed(const Graph* G, const int N)
+{
+  for (auto k = 0; k < SHARDS; ++k) {
+    shards.push_back(std::make_unique<Shard>(G, N));
+  }
+}
+
+SharedClosed::~SharedClosed()
+{
+  for (auto& shard : shards) {
+    for (auto S : shard->nodes) S->~Node();
+  }
+}
+
+int SharedClosed::size() const
+{
+  int cnt = 0;
+  for (auto& shard : shards) cnt += shard->nodes.size();
+  return cnt;
+}
+
+std::pair<Node*, bool> SharedClosed::insert(const Config& C,
+                                            const uint64_t hash, Node* parent,
+                                            Arena& arena)
+{
+  // upper bits, lower ones are used for probing inside the shard
+  const int k = hash >> 58;
+  auto& shard = *shards[k];
+  std::lock_guard<std::mutex> lock(shard.mtx);
+  auto res = shard.table.insert(C, hash);
+  if (!res.second) return {shard.nodes[res.first], false};
+  auto S = arena.create<Node>(res.first * SHARDS + k, parent);
+  shard.nodes.push_back(S);
+  return {S, true};
+}
+
+uint64_t SharedClosed::unpack(const Node* S, Config& C)
+{
+  auto& shard = *shards[S->id % SHARDS];
+  const auto k = S->id / SHARDS;
+  std::lock_guard<std::mutex> lock(shard.mtx);
+  shard.table.unpack(k, C);
+  return shard.table.get_hash(k);
+}
+
+void WorkDeque::push_back(Node* S)
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  nodes.push_back(S);
+  size = nodes.size();
+}
+
+Node* WorkDeque::pop_back()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  if (nodes.empty()) return nullptr;
+  auto S = nodes.back();
+  nodes.pop_back();
+  size = nodes.size();
+  return S;
+}
+
+Node* WorkDeque::pop_front()
+{
+  std::lock_guard<std::mutex> lock(mtx);
+  if (nodes.empty()) return nullptr;
+  auto S = nodes.front();
+  nodes.pop_front();
+  size = nodes.size();
+  return S;
+}
+
+Solution solve_parallel(const Instance& ins, const int threads,
+                        const int verbose, const Deadline* deadline,
+                        const int seed)
+{
+  info(1, verbose, "elapsed:", elapsed_ms(deadline), "ms\tpre-processing");
+  const int N = ins.N;
+  // read-only distance table shared by all threads
+  auto D = DistTable(ins, true);
+
+  std::vector<Arena> arenas(threads);  // for nodes and constraints
+  SharedClosed CLOSED(&ins.G, N);
+  const auto& G = ins.G;
+  std::vector<WorkDeque> deques(threads);
+  std::vector<std::mutex> node_locks(1024);  // striped, for search_tree
+  auto lock_of = [&](Node* S) -> std::mutex& {
+    return node_locks[((uintptr_t)S >> 6) % node_locks.size()];
+  };
+
+  std::atomic<bool> done(false);  // goal found, search space exhausted
+  std::atomic<int> idle(0);       // number of threads without work
+  std::mutex idle_mtx;            // idle threads wait on idle_cv
+  std::condition_variable idle_cv;
+  auto has_work = [&]() {
+    for (auto& q : deques)
+      if (q.size.load() > 0) return true;
+    return false;
+  };
+  // wake idle threads, under the lock to avoid lost wake-ups
+  auto notify = [&](const bool all) {
+    if (idle.load() == 0 && !all) return;
+    std::lock_guard<std::mutex> lock(idle_mtx);
+    if (all) {
+      idle_cv.notify_all();
+    } else {
+      idle_cv.notify_one();
+    }
+  };
+  std::atomic<Node*> goal(nullptr);
+  std::atomic<int> loop_cnt(0);
+  const auto goal_hash = ConfigHasher()(ins.goals);
+
+  // insert initial node
+  deques[0].push_back(
+      CLOSED.insert(ins.starts, ConfigHasher()(ins.starts), nullptr, arenas[0])
+          .first);
+
+  info(1, verbose, "elapsed:", elapsed_ms(deadline), "ms\tstart search with ",
+       threads, " threads");
+  parallel_for(
+      threads,
+      [&](size_t k) {
+        auto MT = std::mt19937(seed + k);
+        auto planner = Planner(&ins, deadline, k == 0 ? nullptr : &MT, 0, &D,
+                               &done);
+        auto& arena = arenas[k];
+        auto C_now = Config(N, nullptr);
+        auto C_new = Config(N, nullptr);
+        int cnt = 0;
+
+        while (!planner.is_interrupted()) {
+          // own stack first, then steal the oldest node of others
+          auto S = deques[k].pop_back();
+          for (auto j = 1; S == nullptr && j < threads; ++j) {
+            S = deques[(k + j) % threads].pop_front();
+          }
+
+          // no work, finish when all threads are idle
+          // the timeout is for noticing the deadline
+          if (S == nullptr) {
+            std::unique_lock<std::mutex> lock(idle_mtx);
+            if (++idle == threads && !has_work()) {
+              done = true;
+              idle_cv.notify_all();
+            }
+            while (!has_work() && !planner.is_interrupted()) {
+              idle_cv.wait_for(lock, std::chrono::milliseconds(1));
+            }
+            --idle;
+            continue;
+          }
+          ++cnt;
+          PROFILE_COUNT(EXPANSIONS);
+
+          // check goal condition
+          const auto hash_now = CLOSED.unpack(S, C_now);
+          if (hash_now == goal_hash && is_same_config(C_now, ins.goals)) {
+            Node* expected = nullptr;
+            goal.compare_exchange_strong(expected, S);
+            done = true;
+            notify(true);
+            break;
+          }
+
+          // low-level search end
+          Constraint* M = nullptr;
+          {
+            std::lock_guard<std::mutex> lock(lock_of(S));
+            if (!S->is_ready() && !S->search_tree.empty()) {
+              planner.setup_node(S, C_now);  // first expansion
+            }
+            if (!S->search_tree.empty()) {
+              M = S->search_tree.front();
+              S->search_tree.pop();
+            }
+          }
+          if (M == nullptr) continue;
+
+          // create successors at the low-level search
+          std::array<Constraint*, 5> children;
+          size_t K = 0;
+          if (M->depth < N) {
+            auto i = S->order[M->depth];
+            const int v = C_now.ids[i];
+            std::array<int, 5> C;
+            for (auto k = G.adj_offsets[v]; k < G.adj_offsets[v + 1]; ++k) {
+              C[K++] = G.adj[k];
+            }
+            C[K++] = v;
+            if (planner.MT != nullptr)
+              std::shuffle(C.begin(), C.begin() + K, *planner.MT);
+            for (size_t l = 0; l < K; ++l) {
+              children[l] = arena.create<Constraint>(M, i, G.V[C[l]]);
+            }
+          }
+          bool pending;
+          {
+            std::lock_guard<std::mutex> lock(lock_of(S));
+            for (size_t l = 0; l < K; ++l) S->search_tree.push(children[l]);
+            pending = !S->search_tree.empty();
+          }
+          // keep S below its successor, as the DFS stack does
+          if (pending) {
+            deques[k].push_back(S);
+            notify(false);
+          }
+
+          // create successors at the high-level search
+          if (!planner.get_new_config(C_now, S->order, M)) continue;
+          auto hash = hash_now;
+          for (auto a : planner.A) {
+            C_new[a->id] = a->v_next;
+            if (a->v_next != a->v_now) {
+              hash = ConfigHasher::update(hash, a->id, a->v_now, a->v_next);
+            }
+          }
+          auto res = CLOSED.insert(C_new, hash, S, arena);
+          if (res.second) {
+            PROFILE_COUNT(CLOSED_MISSES);
+          } else {
+            PROFILE_COUNT(CLOSED_HITS);
+          }
+          deques[k].push_back(res.first);
+          notify(false);
+        }
+        loop_cnt += cnt;
+      },
+      threads);
+
+  // backtrack, then only moves are kept from the start
+  std::vector<Node*> path;
+  for (auto S = goal.load(); S != nullptr; S = S->parent) path.push_back(S);
+  Solution solution;
+  Config C;
+  for (auto k = path.rbegin(); k != path.rend(); ++k) {
+    CLOSED.unpack(*k, C);
+    solution.push_back(C);
+  }
+
+  size_t arena_bytes = 0;
+  for (auto& arena : arenas) arena_bytes += arena.allocated;
+  info(1, verbose, "elapsed:", elapsed_ms(deadline), "ms\t",
+       !solution.empty() ? "solution found"
+       : done.load()     ? "no solution"
+                         : "failed",
+       "\tloop_itr:", loop_cnt.load(), "\texplored:", CLOSED.size(),
+       "\tarena:", arena_bytes, "B");
+  return solution;
+}
@@ -1,247 +1,576 @@
 #include "../include/planner.hpp"
 
-Constraint::Constraint() : who(std::vector<int>()), where(Vertices()), depth(0)
+#include <cstring>
+
+#include "../include/profile.hpp"
+
+Constraint::Constraint()
+    : parent(nullptr), who(-1), where(nullptr), depth(0), next(nullptr)
 {
 }
 
-Constraint::Constraint(Constraint* parent, int i, Vertex* v)
-    : who(parent->who), where(parent->where), depth(parent->depth + 1)
+Constraint::Constraint(Constraint* _parent, int i, Vertex* v)
+    : parent(_parent), who(i), where(v), depth(parent->depth + 1), next(nullptr)
 {
-  who.push_back(i);
-  where.push_back(v);
 }
 
-Constraint::~Constraint(){};
+void ConstraintQueue::push(Constraint* M)
+{
+  M->next = nullptr;
+  if (tail == nullptr) {
+    head = M;
+  } else {
+    tail->next = M;
+  }
+  tail = M;
+}
 
-Node::Node(Config _C, DistTable& D, Node* _parent)
-    : C(_C),
-      parent(_parent),
-      priorities(C.size(), 0),
-      order(C.size(), 0),
-      search_tree(std::queue<Constraint*>())
+void ConstraintQueue::pop()
 {
-  search_tree.push(new Constraint());
-  const auto N = C.size();
+  head = head->next;
+  if (head == nullptr) tail = nullptr;
+}
 
-  // set priorities
-  if (parent == nullptr) {
-    // initialize
-    for (size_t i = 0; i < N; ++i) priorities[i] = (float)D.get(i, C[i]) / N;
-  } else {
-    // dynamic priorities, akin to PIBT
-    for (size_t i = 0; i < N; ++i) {
-      if (D.get(i, C[i]) != 0) {
-        priorities[i] = parent->priorities[i] + 1;
-      } else {
-        priorities[i] = parent->priorities[i] - (int)parent->priorities[i];
+// priorities of a node from those of its parent, nullptr -> initial
+// return the sum of distances to goals, i.e., h-value, from the same lookups
+static int set_priorities(const Config& C, DistTable& D,
+                          const std::vector<float>* parent_priorities,
+                          std::vector<float>& priorities)
+{
+  const auto N = C.size();
+  priorities.resize(N);
+  return D.visit([&](const auto& dist) {
+    int h = 0;
+    if (parent_priorities == nullptr) {
+      // initialize
+      for (size_t i = 0; i < N; ++i) {
+        const auto d = dist.get(i, (int)C.ids[i]);
+        priorities[i] = (float)d / N;
+        h += d;
+      }
+    } else {
+      // dynamic priorities, akin to PIBT
+      auto& p = *parent_priorities;
+      for (size_t i = 0; i < N; ++i) {
+        const auto d = dist.get(i, (int)C.ids[i]);
+        if (d != 0) {
+          priorities[i] = p[i] + 1;
+        } else {
+          priorities[i] = p[i] - (int)p[i];
+        }
+        h += d;
       }
     }
-  }
+    return h;
+  });
+}
+
+Node::Node(const int _id, Node* _parent)
+    : id(_id),
+      parent(_parent),
+      priorities(),
+      order(),
+      search_tree(),
+      root(Constraint())
+{
+  search_tree.push(&root);
+}
+
+bool Node::is_ready() const { return !order.empty(); }
+
+void Node::compact()
+{
+  std::vector<float>().swap(priorities);
+  std::vector<int>().swap(order);
+  search_tree = ConstraintQueue();
+}
+
+bool Node::is_compact() const { return order.empty() && search_tree.empty(); }
+
+void Node::evict() { std::vector<float>().swap(priorities); }
 
-  // set order
+// LSD radix sort on float bits, monotone for non-negative floats
+void sort_order(const std::vector<float>& priorities, std::vector<int>& order,
+                std::vector<uint32_t>& keys, std::vector<uint32_t>& keys_buf,
+                std::vector<int>& order_buf)
+{
+  const int N = priorities.size();
+  order.resize(N);
   std::iota(order.begin(), order.end(), 0);
-  std::sort(order.begin(), order.end(),
-            [&](int i, int j) { return priorities[i] > priorities[j]; });
+  if (N < 64) {
+    std::stable_sort(order.begin(), order.end(), [&](int i, int j) {
+      return priorities[i] > priorities[j];
+    });
+    return;
+  }
+
+  keys.resize(N);
+  keys_buf.resize(N);
+  order_buf.resize(N);
+  for (auto i = 0; i < N; ++i) {
+    uint32_t bits;
+    std::memcpy(&bits, &priorities[i], 4);
+    keys[i] = ~bits;  // descending
+  }
+  constexpr int BITS = 11;
+  std::array<int, 1 << BITS> cnt;
+  for (auto shift = 0; shift < 32; shift += BITS) {
+    cnt.fill(0);
+    for (auto i = 0; i < N; ++i) ++cnt[(keys[i] >> shift) & ((1 << BITS) - 1)];
+    for (int b = 0, sum = 0; b < (1 << BITS); ++b) {
+      const auto c = cnt[b];
+      cnt[b] = sum;
+      sum += c;
+    }
+    for (auto i = 0; i < N; ++i) {
+      const auto k = cnt[(keys[i] >> shift) & ((1 << BITS) - 1)]++;
+      keys_buf[k] = keys[i];
+      order_buf[k] = order[i];
+    }
+    keys.swap(keys_buf);
+    order.swap(order_buf);
+  }
+}
+
+int Planner::setup_node(Node* S, const Config& C)
+{
+  auto P = S->parent;
+  if (P != nullptr && P->priorities.empty()) restore_priorities(P);
+  const auto h = set_priorities(C, D, P == nullptr ? nullptr : &P->priorities,
+                                S->priorities);
+  sort_order(S->priorities, S->order, sort_keys, sort_keys_buf, sort_buf);
+  return h;
 }
 
-Node::~Node()
+void Planner::restore_priorities(Node* S)
 {
-  while (!search_tree.empty()) {
-    delete search_tree.front();
-    search_tree.pop();
+  // replay from the nearest ancestor with priorities, or from the start
+  Nodes path;
+  auto n = S;
+  for (; n != nullptr && n->priorities.empty(); n = n->parent) {
+    path.push_back(n);
   }
+  auto p = n == nullptr ? std::vector<float>() : n->priorities;
+  auto q = std::vector<float>();
+  auto C = Config(N, nullptr);
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+    CLOSED->unpack((*it)->id, C);
+    set_priorities(C, D, p.empty() ? nullptr : &p, q);
+    p.swap(q);
+  }
+  S->priorities = std::move(p);
 }
 
+bool Planner::FLG_ANYTIME = false;
+size_t Planner::MEMORY_BUDGET = 0;
+
 Planner::Planner(const Instance* _ins, const Deadline* _deadline,
-                 std::mt19937* _MT, int _verbose)
+                 std::mt19937* _MT, int _verbose, DistTable* _D,
+                 const std::atomic<bool>* _stop)
     : ins(_ins),
       deadline(_deadline),
       MT(_MT),
       verbose(_verbose),
+      stop(_stop),
       N(ins->N),
       V_size(ins->G.size()),
-      D(DistTable(ins)),
-      C_next(Candidates(N, std::array<Vertex*, 5>())),
+      D_owned(_D == nullptr ? new DistTable(ins) : nullptr),
+      D(_D == nullptr ? *D_owned : *_D),
+      C_next(Candidates(N, std::array<int, 5>())),
       tie_breakers(std::vector<float>(V_size, 0)),
       A(Agents(N, nullptr)),
       occupied_now(Agents(V_size, nullptr)),
-      occupied_next(Agents(V_size, nullptr))
+      occupied_next(Agents(V_size, nullptr)),
+      occupied_now_gen(V_size, 0),
+      generation(0),
+      cnt_attempts(0),
+      cnt_configs(0),
+      cnt_compacted(0),
+      cnt_evicted(0),
+      spilled_bytes(0),
+      CLOSED(nullptr)
 {
+  touched.reserve(N);
+  for (auto i = 0; i < N; ++i) A[i] = new Agent(i);
+}
+
+Planner::~Planner()
+{
+  for (auto a : A) delete a;
 }
 
 Solution Planner::solve()
 {
   info(1, verbose, "elapsed:", elapsed_ms(deadline), "ms\tstart search");
 
-  // setup agents
-  for (auto i = 0; i < N; ++i) A[i] = new Agent(i);
-
   // setup search queues
   std::stack<Node*> OPEN;
-  std::unordered_map<Config, Node*, ConfigHasher> CLOSED;
-  std::vector<Constraint*> GC;  // garbage collection of constraints
+  Nodes nodes;  // index: config-id in CLOSED
+  Arena arena;  // for nodes and constraints, released after search
+  CLOSED = std::make_unique<ConfigTable>(&ins->G, N);
+  anytime.clear();
 
   // insert initial node
-  auto S = new Node(ins->starts, D);
+  auto S = arena.create<Node>(CLOSED->insert(ins->starts).first);
   OPEN.push(S);
-  CLOSED[S->C] = S;
+  nodes.push_back(S);
+  if (FLG_ANYTIME) anytime.push_back(AnytimeNode{{}, 0, 0});
+  const auto goal_hash = ConfigHasher()(ins->goals);
 
   // depth first search
   int loop_cnt = 0;
-  std::vector<Config> solution;
+  auto C_now = Config(N, nullptr);  // configuration of S
+  int C_now_id = -1;                // config-id of C_now
+  Node* S_goal = nullptr;
 
-  while (!OPEN.empty() && !is_expired(deadline)) {
+  while (!OPEN.empty() && !is_interrupted()) {
     loop_cnt += 1;
+    PROFILE_COUNT(EXPANSIONS);
+    PROFILE_TIMER(TIME_EXPANSION_NS);
 
     // do not pop here!
     S = OPEN.top();
 
     // check goal condition
-    if (is_same_config(S->C, ins->goals)) {
-      // backtrack
-      while (S != nullptr) {
-        solution.push_back(S->C);
-        S = S->parent;
-      }
-      std::reverse(solution.begin(), solution.end());
-      break;
+    if (S_goal == nullptr && CLOSED->get_hash(S->id) == goal_hash &&
+        CLOSED->is_same(S->id, ins->goals)) {
+      S_goal = S;
+      if (!FLG_ANYTIME) break;
+      info(1, verbose, "elapsed:", elapsed_ms(deadline),
+           "ms\tinitial solution, sum_of_loss:", anytime[S_goal->id].g);
+    }
+
+    // configuration and first expansion
+    if (S->id != C_now_id) {
+      CLOSED->unpack(S->id, C_now);
+      C_now_id = S->id;
+    }
+    if (!S->is_ready() && !S->search_tree.empty()) {
+      const auto h = setup_node(S, C_now);
+      if (FLG_ANYTIME) anytime[S->id].h = h;
+    }
+
+    // skip nodes that cannot improve the current solution
+    if (S_goal != nullptr &&
+        anytime[S->id].g + anytime[S->id].h >= anytime[S_goal->id].g) {
+      OPEN.pop();
+      continue;
     }
 
     // low-level search end
     if (S->search_tree.empty()) {
       OPEN.pop();
+      if (MEMORY_BUDGET > 0 && !S->is_compact()) {
+        S->compact();
+        ++cnt_compacted;
+      }
       continue;
     }
+    if (MEMORY_BUDGET > 0 && loop_cnt % 1024 == 0) {
+      fit_memory(nodes, arena, S);
+    }
 
     // create successors at the low-level search
     auto M = S->search_tree.front();
-    GC.push_back(M);
     S->search_tree.pop();
     if (M->depth < N) {
       auto i = S->order[M->depth];
-      auto C = S->C[i]->neighbor;
-      C.push_back(S->C[i]);
-      if (MT != nullptr) std::shuffle(C.begin(), C.end(), *MT);  // randomize
-      for (auto u : C) S->search_tree.push(new Constraint(M, i, u));
+      const auto& G = ins->G;
+      const int v = C_now.ids[i];
+      std::array<int, 5> C;
+      const int K = G.adj_offsets[v + 1] - G.adj_offsets[v];
+      std::copy_n(G.adj.begin() + G.adj_offsets[v], K, C.begin());
+      C[K] = v;
+      if (MT != nullptr) std::shuffle(C.begin(), C.begin() + K + 1, *MT);
+      for (auto l = 0; l <= K; ++l) {
+        S->search_tree.push(arena.create<Constraint>(M, i, G.V[C[l]]));
+      }
     }
 
     // create successors at the high-level search
-    if (!get_new_config(S, M)) continue;
+    if (!get_new_config(C_now, S->order, M)) continue;
 
-    // create new configuration
+    // create new configuration, hash is updated only for moved agents
     auto C = Config(N, nullptr);
-    for (auto a : A) C[a->id] = a->v_next;
+    auto hash = CLOSED->get_hash(S->id);
+    for (auto a : A) {
+      C[a->id] = a->v_next;
+      if (a->v_next != a->v_now) {
+        hash = ConfigHasher::update(hash, a->id, a->v_now, a->v_next);
+      }
+    }
 
     // check explored list
-    auto iter = CLOSED.find(C);
-    if (iter != CLOSED.end()) {
-      OPEN.push(iter->second);
+    auto res = CLOSED->insert(C, hash);
+    if (!res.second) {
+      PROFILE_COUNT(CLOSED_HITS);
+      auto S_known = nodes[res.first];
+      if (FLG_ANYTIME) {
+        rewrite(S, S_known, get_edge_cost(C_now, C), S_goal);
+      }
+      // occasionally restart from the initial node to diversify refinement
+      if (S_goal != nullptr && MT != nullptr &&
+          get_random_float(MT) < RESTART_RATE) {
+        OPEN.push(nodes.front());
+      } else {
+        OPEN.push(S_known);
+      }
       continue;
     }
 
     // insert new search node
-    auto S_new = new Node(C, D, S);
+    PROFILE_COUNT(CLOSED_MISSES);
+    auto S_new = arena.create<Node>(res.first, S);
     OPEN.push(S_new);
-    CLOSED[S_new->C] = S_new;
+    nodes.push_back(S_new);
+    if (FLG_ANYTIME) {
+      const auto cost = get_edge_cost(C_now, C);
+      anytime[S->id].neighbor.emplace(S_new, cost);
+      anytime.push_back(AnytimeNode{{}, anytime[S->id].g + cost, 0});
+    }
+  }
+
+  // backtrack, then only moves are kept from the start
+  std::vector<int> path;  // config-ids
+  for (S = S_goal; S != nullptr; S = S->parent) path.push_back(S->id);
+  // moves between consecutive configurations are taken from packed ones
+  // metrics are tracked as the solution grows
+  Solution solution;
+  auto tracker = MetricsTracker(ins->goals);
+  std::vector<Solution::Move> moves;
+  if (!path.empty() && CLOSED->unpack(path.back(), C_now)) {
+    solution.push_back(C_now);
+    tracker.update(solution);
+  }
+  for (auto j = path.size() - 1; !solution.empty() && j > 0; --j) {
+    if (!CLOSED->get_moves(path[j], path[j - 1], moves)) {
+      solution.clear();  // lost configurations in spilled chunks
+      break;
+    }
+    solution.push_moves(moves);
+    tracker.update(solution);
   }
+  metrics = solution.empty() ? Metrics() : tracker.get();
 
   info(1, verbose, "elapsed:", elapsed_ms(deadline), "ms\t",
        solution.empty() ? (OPEN.empty() ? "no solution" : "failed")
                         : "solution found",
-       "\tloop_itr:", loop_cnt, "\texplored:", CLOSED.size());
+       "\tloop_itr:", loop_cnt, "\texplored:", CLOSED->size(),
+       "\tconfigs:", cnt_configs, "/", cnt_attempts,
+       "\tarena:", arena.allocated, "B");
+  if (MEMORY_BUDGET > 0) {
+    info(1, verbose, "elapsed:", elapsed_ms(deadline),
+         "ms\tmemory budget:", MEMORY_BUDGET >> 20, "MB\tcompacted:",
+         cnt_compacted, "\tevicted:", cnt_evicted,
+         "\tspilled:", spilled_bytes >> 20,
+         "MB\tpeak_rss:", get_peak_rss() >> 20, "MB");
+  }
   // memory management
-  for (auto a : A) delete a;
-  for (auto M : GC) delete M;
-  for (auto p : CLOSED) delete p.second;
+  for (auto S : nodes) S->~Node();
+  std::vector<AnytimeNode>().swap(anytime);
 
   return solution;
 }
 
-bool Planner::get_new_config(Node* S, Constraint* M)
+void Planner::fit_memory(const Nodes& nodes, const Arena& arena,
+                         Node* S_top)
 {
-  // setup cache
-  for (auto a : A) {
-    // clear previous cache
-    if (a->v_now != nullptr && occupied_now[a->v_now->id] == a) {
-      occupied_now[a->v_now->id] = nullptr;
+  // rough estimate, nodes themselves are in the arena
+  auto node_bytes = [&](Node* S) {
+    return S->priorities.capacity() * sizeof(float) +
+           S->order.capacity() * sizeof(int);
+  };
+  auto used = CLOSED->bytes() + arena.allocated;
+  for (auto S : nodes) used += node_bytes(S);
+  if (used <= MEMORY_BUDGET) return;
+
+  // fully expanded nodes, not popped yet
+  for (auto S : nodes) {
+    if (S->is_compact() || !S->search_tree.empty()) continue;
+    used -= node_bytes(S);
+    S->compact();
+    ++cnt_compacted;
+  }
+
+  // priorities of old nodes off the current path
+  if (used > MEMORY_BUDGET) {
+    std::vector<bool> on_path(nodes.size(), false);
+    for (auto S = S_top; S != nullptr; S = S->parent) on_path[S->id] = true;
+    for (auto S : nodes) {
+      if (used <= MEMORY_BUDGET) break;
+      if (on_path[S->id] || S->priorities.empty()) continue;
+      used -= S->priorities.capacity() * sizeof(float);
+      S->evict();
+      ++cnt_evicted;
     }
-    if (a->v_next != nullptr) {
-      occupied_next[a->v_next->id] = nullptr;
-      a->v_next = nullptr;
+  }
+
+  if (used > MEMORY_BUDGET) {
+    spilled_bytes += CLOSED->spill(used - MEMORY_BUDGET);
+  }
+}
+
+int Planner::get_edge_cost(const Config& C_from, const Config& C_to) const
+{
+  // agents staying at their goals are free, as in get_sum_of_loss
+  int cost = 0;
+  const auto& goals = ins->goals.ids;
+  for (auto i = 0; i < N; ++i) {
+    if (C_from.ids[i] != goals[i] || C_to.ids[i] != goals[i]) ++cost;
+  }
+  return cost;
+}
+
+void Planner::rewrite(Node* S_from, Node* S_to, const int cost,
+                      Node* S_goal)
+{
+  anytime[S_from->id].neighbor.emplace(S_to, cost);
+
+  // Dijkstra update of g over known edges, edge costs are positive
+  // stale entries, i.e., g larger than the current one, are skipped
+  using Entry = std::pair<int, Node*>;  // g, node
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > Q;
+  Q.emplace(anytime[S_from->id].g, S_from);
+  while (!Q.empty()) {
+    const auto [g_from, n_from] = Q.top();
+    Q.pop();
+    if (g_from != anytime[n_from->id].g) continue;
+    for (const auto& [n_to, c] : anytime[n_from->id].neighbor) {
+      const auto g = g_from + c;
+      if (g >= anytime[n_to->id].g) continue;
+      anytime[n_to->id].g = g;
+      n_to->parent = n_from;
+      Q.emplace(g, n_to);
+      if (n_to == S_goal) {
+        info(1, verbose, "elapsed:", elapsed_ms(deadline),
+             "ms\tsolution improved, sum_of_loss:",
+             anytime[S_goal->id].g);
+      }
     }
+  }
+}
 
-    // set occupied now
-    a->v_now = S->C[a->id];
-    occupied_now[a->v_now->id] = a;
+bool Planner::is_interrupted() const
+{
+  return is_expired(deadline) ||
+         (stop != nullptr && stop->load(std::memory_order_relaxed)) ||
+         (CLOSED != nullptr && CLOSED->read_failed);
+}
+
+bool Planner::get_new_config(const Config& C, const std::vector<int>& order,
+                             Constraint* M)
+{
+  ++cnt_attempts;
+  PROFILE_COUNT(CONSTRAINTS);
+  PROFILE_TIMER(TIME_NEW_CONFIG_NS);
+
+  // clear previous cache, cost is proportional to the previous work
+  for (auto a : touched) {
+    occupied_next[a->v_next->id] = nullptr;
+    a->v_next = nullptr;
   }
+  touched.clear();
 
   // add constraints
-  for (auto k = 0; k < M->depth; ++k) {
-    const auto i = M->who[k];        // agent
-    const auto l = M->where[k]->id;  // loc
+  for (auto m = M; m->depth > 0; m = m->parent) {
+    const auto i = m->who;        // agent
+    const auto l = m->where->id;  // loc
 
     // check vertex collision
-    if (occupied_next[l] != nullptr) return false;
+    if (occupied_next[l] != nullptr) {
+      PROFILE_COUNT(FAIL_VERTEX);
+      return false;
+    }
     // check swap collision
-    auto l_pre = S->C[i]->id;
-    if (occupied_next[l_pre] != nullptr && occupied_now[l] != nullptr &&
-        occupied_next[l_pre]->id == occupied_now[l]->id)
+    auto aj = occupied_next[C.ids[i]];
+    if (aj != nullptr && C[aj->id] == m->where) {
+      PROFILE_COUNT(FAIL_SWAP);
       return false;
+    }
 
     // set occupied_next
-    A[i]->v_next = M->where[k];
+    A[i]->v_next = m->where;
     occupied_next[l] = A[i];
+    touched.push_back(A[i]);
   }
 
-  // perform PIBT
-  for (auto k : S->order) {
-    auto a = A[k];
-    if (a->v_next == nullptr && !funcPIBT(a)) return false;  // planning failure
+  // set occupied now, previous entries are invalidated by the generation
+  if (++generation == 0) {
+    std::fill(occupied_now_gen.begin(), occupied_now_gen.end(), 0);
+    generation = 1;
   }
-  return true;
+  for (auto a : A) {
+    a->v_now = C[a->id];
+    occupied_now[a->v_now->id] = a;
+    occupied_now_gen[a->v_now->id] = generation;
+  }
+
+  // perform PIBT, the distance lookup is chosen once
+  return D.visit([&](const auto& dist) {
+    for (auto k : order) {
+      auto a = A[k];
+      if (a->v_next == nullptr && !funcPIBT(a, dist)) {
+        PROFILE_COUNT(FAIL_PIBT);
+        return false;  // planning failure
+      }
+    }
+    ++cnt_configs;
+    return true;
+  });
 }
 
-bool Planner::funcPIBT(Agent* ai)
+Agent* Planner::get_occupied_now(const int v_id) const
 {
+  return occupied_now_gen[v_id] == generation ? occupied_now[v_id] : nullptr;
+}
+
+template <typename Lookup>
+bool Planner::funcPIBT(Agent* ai, const Lookup& dist)
+{
+  PROFILE_COUNT(PIBT_CALLS);
+  PROFILE_DEPTH();
   const auto i = ai->id;
-  const auto K = ai->v_now->neighbor.size();
-
-  // get candidates for next locations
-  for (size_t k = 0; k < K; ++k) {
-    auto u = ai->v_now->neighbor[k];
-    C_next[i][k] = u;
-    if (MT != nullptr)
-      tie_breakers[u->id] = get_random_float(MT);  // set tie-breaker
+  const auto& G = ins->G;
+  const int v_now = ai->v_now->id;
+  const auto nbr = G.adj.begin() + G.adj_offsets[v_now];
+  const int K = G.adj_offsets[v_now + 1] - G.adj_offsets[v_now];
+  auto& C = C_next[i];
+  touched.push_back(ai);
+
+  // get candidates for next locations, from CSR
+  std::copy_n(nbr, K, C.begin());
+  if (MT != nullptr) {
+    for (auto k = 0; k < K; ++k) {
+      tie_breakers[C[k]] = get_random_float(MT);  // set tie-breaker
+    }
   }
-  C_next[i][K] = ai->v_now;
+  C[K] = v_now;
 
   // sort, note: K + 1 is sufficient
-  std::sort(C_next[i].begin(), C_next[i].begin() + K + 1,
-            [&](Vertex* const v, Vertex* const u) {
-              return D.get(i, v) + tie_breakers[v->id] <
-                     D.get(i, u) + tie_breakers[u->id];
-            });
+  std::sort(C.begin(), C.begin() + K + 1, [&](const int v, const int u) {
+    return dist.get(i, v) + tie_breakers[v] < dist.get(i, u) + tie_breakers[u];
+  });
 
-  for (size_t k = 0; k < K + 1; ++k) {
-    auto u = C_next[i][k];
+  for (auto k = 0; k < K + 1; ++k) {
+    const auto u = C[k];
 
     // avoid vertex conflicts
-    if (occupied_next[u->id] != nullptr) continue;
+    if (occupied_next[u] != nullptr) continue;
 
-    auto& ak = occupied_now[u->id];
+    auto ak = get_occupied_now(u);
 
     // avoid swap conflicts with constraints
     if (ak != nullptr && ak->v_next == ai->v_now) continue;
 
     // reserve next location
-    occupied_next[u->id] = ai;
-    ai->v_next = u;
+    occupied_next[u] = ai;
+    ai->v_next = G.V[u];
 
     // empty or stay
-    if (ak == nullptr || u == ai->v_now) return true;
+    if (ak == nullptr || u == v_now) return true;
 
     // priority inheritance
-    if (ak->v_next == nullptr && !funcPIBT(ak)) continue;
+    if (ak->v_next == nullptr && !funcPIBT(ak, dist)) continue;
 
     // success to plan next one step
     return true;
@@ -254,9 +583,44 @@ bool Planner::funcPIBT(Agent* ai)
 }
 
 Solution solve(const Instance& ins, const int verbose, const Deadline* deadline,
-               std::mt19937* MT)
+               std::mt19937* MT, Metrics* metrics)
 {
   info(1, verbose, "elapsed:", elapsed_ms(deadline), "ms\tpre-processing");
   auto planner = Planner(&ins, deadline, MT, verbose);
-  return planner.solve();
+  auto solution = planner.solve();
+  if (metrics != nullptr) *metrics = std::move(planner.metrics);
+  return solution;
+}
+
+Solution solve_portfolio(const Instance& ins, const int threads,
+                         const int verbose, const Deadline* deadline,
+                         const int seed)
+{
+  info(1, verbose, "elapsed:", elapsed_ms(deadline), "ms\tpre-processing");
+  // read-only distance table shared by all planners
+  auto D = DistTable(ins, true);
+
+  std::atomic<bool> stop(false);
+  Solution solution;
+  int winner = -1;
+  parallel_for(
+      threads,
+      [&](size_t k) {
+        auto MT = std::mt19937(seed + k);
+        auto planner = Planner(&ins, deadline, k == 0 ? nullptr : &MT, 0, &D,
+                               &stop);
+        auto sol = planner.solve();
+        // interrupted without result
+        if (sol.empty() && planner.is_interrupted()) return;
+        // the first finished planner wins, others are cancelled
+        if (stop.exchange(true)) return;
+        solution = std::move(sol);
+        winner = k;
+      },
+      threads);
+
+  info(1, verbose, "elapsed:", elapsed_ms(deadline), "ms\t",
+       winner < 0 ? "failed" : "finished", " by planner-", winner, " of ",
+       threads);
+  return solution;
 }
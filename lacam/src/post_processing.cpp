@@ -1,55 +1,284 @@
 #include "../include/post_processing.hpp"
 
+#include <atomic>
+#include <sstream>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include "../include/dist_table.hpp"
+#include "../include/profile.hpp"
 
-bool is_feasible_solution(const Instance& ins, const Solution& solution,
-                          const int verbose)
+bool Violation::operator<(const Violation& other) const
 {
-  if (solution.empty()) return true;
+  if (kind == NONE || other.kind == NONE) return other.kind == NONE;
+  if (time != other.time) return time < other.time;
+  if (agent != other.agent) return agent < other.agent;
+  return kind < other.kind;
+}
 
-  // check start locations
-  if (!is_same_config(solution.front(), ins.starts)) {
-    info(1, verbose, "invalid starts");
-    return false;
+std::ostream& operator<<(std::ostream& os, const Violation& violation)
+{
+  static const char* names[] = {"none",         "invalid starts",
+                                "invalid goals", "invalid move",
+                                "vertex conflict", "edge conflict"};
+  os << names[violation.kind];
+  if (violation.kind != Violation::NONE) {
+    os << ", agent-" << violation.agent << " at t=" << violation.time;
   }
+  return os;
+}
 
-  // check goal locations
-  if (!is_same_config(solution.back(), ins.goals)) {
-    info(1, verbose, "invalid goals");
-    return false;
+// first index i with C1[i] != C2[i], or N
+static size_t find_mismatch(const Config& C1, const Config& C2, size_t i = 0)
+{
+  const auto N = C1.size();
+  const auto a = C1.ids.data();
+  const auto b = C2.ids.data();
+#ifdef __AVX2__
+  // eight vertex-ids at once
+  for (; i + 8 <= N; i += 8) {
+    const auto x = _mm256_loadu_si256((const __m256i*)(a + i));
+    const auto y = _mm256_loadu_si256((const __m256i*)(b + i));
+    const auto eq = _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y)));
+    if (eq != 0xff) return i + __builtin_ctz(~eq & 0xff);
   }
+#endif
+  for (; i < N; ++i) {
+    if (a[i] != b[i]) return i;
+  }
+  return N;
+}
 
-  for (size_t t = 1; t < solution.size(); ++t) {
-    for (size_t i = 0; i < ins.N; ++i) {
-      auto v_i_from = solution[t - 1][i];
-      auto v_i_to = solution[t][i];
-      // check connectivity
-      if (v_i_from != v_i_to &&
-          std::find(v_i_to->neighbor.begin(), v_i_to->neighbor.end(),
-                    v_i_from) == v_i_to->neighbor.end()) {
-        info(1, verbose, "invalid move");
-        return false;
+// transitions into timesteps [t_from, t_to), only moving agents are checked
+static Violation validate_transitions(const Instance& ins,
+                                      const Solution& solution,
+                                      const int t_from, const int t_to)
+{
+  const auto& G = ins.G;
+  // configuration and occupancy, updated by moves
+  auto C = solution.get(t_from - 1);
+  std::vector<int> who(G.size(), -1);
+  for (size_t i = 0; i < ins.N; ++i) who[C.ids[i]] = i;
+  std::vector<int> from;  // index: move at t
+  std::vector<Solution::Move> moves;  // unpacked moves at t
+
+  for (auto t = t_from; t < t_to; ++t) {
+    Violation res;
+    moves.clear();
+    for (auto k = solution.offsets[t]; k < solution.offsets[t + 1]; ++k) {
+      moves.push_back(solution.get_move(k));
+    }
+    const auto m_begin = moves.cbegin();
+    const auto m_end = moves.cend();
+    from.clear();
+    for (auto m = m_begin; m != m_end; ++m) {
+      from.push_back(C.ids[m->agent]);
+      C.ids[m->agent] = m->to;
+    }
+
+    // connectivity and swaps, occupancy is of t-1 here
+    for (auto m = m_begin; m != m_end; ++m) {
+      const int i = m->agent;
+      const int v_from = from[m - m_begin];
+      const int v_to = m->to;
+      const auto nbr_end = G.adj.begin() + G.adj_offsets[v_from + 1];
+      if (std::find(G.adj.begin() + G.adj_offsets[v_from], nbr_end, v_to) ==
+          nbr_end) {
+        res = std::min(res, Violation(Violation::INVALID_MOVE, i, t));
+        continue;
+      }
+      // the agent previously at v_to moved to v_from
+      const auto j = who[v_to];
+      if (j >= 0 && (int)C.ids[j] == v_from) {
+        res = std::min(res, Violation(Violation::SWAP_CONFLICT,
+                                      std::min(i, j), t));
+      }
+    }
+
+    // occupancy of t, moving agents leave first
+    for (auto m = m_begin; m != m_end; ++m) {
+      auto& w = who[from[m - m_begin]];
+      if (w == (int)m->agent) w = -1;
+    }
+    for (auto m = m_begin; m != m_end; ++m) {
+      auto& w = who[m->to];
+      if (w >= 0) {
+        res = std::min(res, Violation(Violation::VERTEX_CONFLICT,
+                                      std::min(w, (int)m->agent), t));
+      } else {
+        w = m->agent;
       }
+    }
+    if (res.kind != Violation::NONE) return res;
+  }
+  return Violation();
+}
+
+Violation validate_solution(const Instance& ins, const Solution& solution,
+                            const int threads)
+{
+  if (solution.empty()) return Violation();
 
-      // check conflicts
-      for (size_t j = i + 1; j < ins.N; ++j) {
-        auto v_j_from = solution[t - 1][j];
-        auto v_j_to = solution[t][j];
-        // vertex conflicts
-        if (v_j_to == v_i_to) {
-          info(1, verbose, "vertex conflict");
-          return false;
+  // check start and goal locations
+  auto i = find_mismatch(solution.front(), ins.starts);
+  if (i < ins.N) return Violation(Violation::INVALID_START, i, 0);
+  i = find_mismatch(solution.back(), ins.goals);
+  if (i < ins.N) {
+    return Violation(Violation::INVALID_GOAL, i, solution.size() - 1);
+  }
+
+  // chunks of timesteps, later ones stop once an earlier violation is found
+  const int T = solution.size();
+  const int chunk = std::max(T / 64, 65536 / (int)ins.N + 1);
+  const int num_chunks = (T - 1 + chunk - 1) / chunk;
+  std::vector<Violation> results(num_chunks);
+  std::atomic<int> first_bad_chunk(num_chunks);
+  parallel_for(
+      num_chunks,
+      [&](size_t k) {
+        if ((int)k > first_bad_chunk.load()) return;
+        const int t_from = 1 + k * chunk;
+        const int t_to = std::min(T, t_from + chunk);
+        results[k] = validate_transitions(ins, solution, t_from, t_to);
+        if (results[k].kind == Violation::NONE) return;
+        auto cur = first_bad_chunk.load();
+        while ((int)k < cur && !first_bad_chunk.compare_exchange_weak(cur, k)) {
         }
-        // swap conflicts
-        if (v_j_to == v_i_from && v_j_from == v_i_to) {
-          info(1, verbose, "edge conflict");
-          return false;
+      },
+      threads);
+  for (auto& res : results) {
+    if (res.kind != Violation::NONE) return res;
+  }
+  return Violation();
+}
+
+bool is_feasible_solution(const Instance& ins, const Solution& solution,
+                          const int verbose)
+{
+  const auto violation = validate_solution(ins, solution);
+  if (violation.kind == Violation::NONE) return true;
+  info(1, verbose, violation);
+  return false;
+}
+
+Metrics get_metrics(const Solution& solution, const int threads)
+{
+  if (solution.empty()) return Metrics();
+  const int N = solution.N;
+  const int T = solution.size();
+  const int chunk = std::max(T / 64, 65536 / N + 1);
+  const int num_chunks = (T - 1 + chunk - 1) / chunk;
+  if (num_chunks <= 1 || threads == 1) {
+    auto tracker = MetricsTracker(solution.back());
+    tracker.update(solution);
+    return tracker.get();
+  }
+
+  // per chunk and agent, first and last moves
+  // stays before the first move of each chunk are resolved by merging
+  struct Part {
+    std::vector<int> first;  // -1 -> no move
+    std::vector<int> last;
+    std::vector<char> at_goal;  // before the first move
+    int stays;                  // between moves in the chunk
+  };
+  const auto& goals = solution.back().ids;
+  std::vector<Part> parts(num_chunks);
+  parallel_for(
+      num_chunks,
+      [&](size_t k) {
+        const int t_from = 1 + k * chunk;
+        const int t_to = std::min(T, t_from + chunk);
+        auto& part = parts[k];
+        part.first.assign(N, -1);
+        part.last.assign(N, -1);
+        part.at_goal.assign(N, false);
+        part.stays = 0;
+        auto C = solution.get(t_from - 1);
+        for (auto i = 0; i < N; ++i) part.at_goal[i] = C.ids[i] == goals[i];
+        for (auto t = t_from; t < t_to; ++t) {
+          for (auto l = solution.offsets[t]; l < solution.offsets[t + 1];
+               ++l) {
+            const auto m = solution.get_move(l);
+            const auto i = m.agent;
+            if (part.first[i] < 0) {
+              part.first[i] = t;
+            } else if (C.ids[i] == goals[i]) {
+              part.stays += t - 1 - part.last[i];
+            }
+            C.ids[i] = m.to;
+            part.last[i] = t;
+          }
         }
-      }
+      },
+      threads);
+
+  // merge, in parallel across agents
+  Metrics metrics;
+  metrics.makespan = T - 1;
+  metrics.path_costs.assign(N, 0);
+  std::vector<int> stays(N, 0);
+  parallel_for(
+      N,
+      [&](size_t i) {
+        int since = 0;  // arrival at the current vertex
+        for (auto& part : parts) {
+          if (part.first[i] < 0) continue;
+          if (part.at_goal[i]) stays[i] += part.first[i] - 1 - since;
+          since = part.last[i];
+        }
+        metrics.path_costs[i] = since;
+      },
+      threads);
+  for (auto& part : parts) metrics.sum_of_loss -= part.stays;
+  for (auto i = 0; i < N; ++i) {
+    metrics.sum_of_costs += metrics.path_costs[i];
+    metrics.sum_of_loss -= stays[i];
+  }
+  metrics.sum_of_loss += metrics.sum_of_costs;
+  return metrics;
+}
+
+MetricsTracker::MetricsTracker(const Config& _goals)
+    : goals(_goals),
+      T(0),
+      C(),
+      since(goals.size(), 0),
+      path_costs(goals.size(), 0),
+      stays(0)
+{
+}
+
+void MetricsTracker::update(const Solution& solution)
+{
+  if (T == 0 && !solution.empty()) {
+    C = solution.front();
+    T = 1;
+  }
+  for (; T < solution.size(); ++T) {
+    const int t = T;
+    for (auto k = solution.offsets[t]; k < solution.offsets[t + 1]; ++k) {
+      const auto m = solution.get_move(k);
+      if (C.ids[m.agent] == goals.ids[m.agent]) stays += t - 1 - since[m.agent];
+      C.ids[m.agent] = m.to;
+      since[m.agent] = t;
+      path_costs[m.agent] = t;
     }
   }
+}
 
-  return true;
+Metrics MetricsTracker::get() const
+{
+  Metrics metrics;
+  if (T == 0) return metrics;
+  metrics.makespan = T - 1;
+  metrics.path_costs = path_costs;
+  for (auto c : path_costs) metrics.sum_of_costs += c;
+  metrics.sum_of_loss = metrics.sum_of_costs - stays;
+  return metrics;
 }
 
 int get_makespan(const Solution& solution)
@@ -60,35 +289,24 @@ int get_makespan(const Solution& solution)
 
 int get_path_cost(const Solution& solution, int i)
 {
-  const auto makespan = solution.size();
-  const auto g = solution.back()[i];
-  auto c = makespan;
-  while (c > 0 && solution[c - 1][i] == g) --c;
-  return c;
+  // timestep of the last move
+  const auto& offsets = solution.offsets;
+  for (auto k = solution.num_moves; k > 0; --k) {
+    if ((int)solution.get_move(k - 1).agent != i) continue;
+    return std::upper_bound(offsets.begin(), offsets.end(), k - 1) -
+           offsets.begin() - 1;
+  }
+  return 0;
 }
 
 int get_sum_of_costs(const Solution& solution)
 {
-  if (solution.empty()) return 0;
-  int c = 0;
-  const auto N = solution.front().size();
-  for (size_t i = 0; i < N; ++i) c += get_path_cost(solution, i);
-  return c;
+  return get_metrics(solution).sum_of_costs;
 }
 
 int get_sum_of_loss(const Solution& solution)
 {
-  if (solution.empty()) return 0;
-  int c = 0;
-  const auto N = solution.front().size();
-  const auto T = solution.size();
-  for (size_t i = 0; i < N; ++i) {
-    auto g = solution.back()[i];
-    for (size_t t = 1; t < T; ++t) {
-      if (solution[t - 1][i] != g || solution[t][i] != g) ++c;
-    }
-  }
-  return c;
+  return get_metrics(solution).sum_of_loss;
 }
 
 int get_makespan_lower_bound(const Instance& ins, DistTable& dist_table)
@@ -111,14 +329,20 @@ int get_sum_of_costs_lower_bound(const Instance& ins, DistTable& dist_table)
 
 void print_stats(const int verbose, const Instance& ins,
                  const Solution& solution, const double comp_time_ms)
+{
+  print_stats(verbose, ins, get_metrics(solution), comp_time_ms);
+}
+
+void print_stats(const int verbose, const Instance& ins,
+                 const Metrics& metrics, const double comp_time_ms)
 {
   auto ceil = [](float x) { return std::ceil(x * 100) / 100; };
   auto dist_table = DistTable(ins);
-  const auto makespan = get_makespan(solution);
+  const auto makespan = metrics.makespan;
   const auto makespan_lb = get_makespan_lower_bound(ins, dist_table);
-  const auto sum_of_costs = get_sum_of_costs(solution);
+  const auto sum_of_costs = metrics.sum_of_costs;
   const auto sum_of_costs_lb = get_sum_of_costs_lower_bound(ins, dist_table);
-  const auto sum_of_loss = get_sum_of_loss(solution);
+  const auto sum_of_loss = metrics.sum_of_loss;
   info(1, verbose, "solved: ", comp_time_ms, "ms", "\tmakespan: ", makespan,
        " (lb=", makespan_lb, ", ub=", ceil((float)makespan / makespan_lb), ")",
        "\tsum_of_costs: ", sum_of_costs, " (lb=", sum_of_costs_lb,
@@ -127,59 +351,60 @@ void print_stats(const int verbose, const Instance& ins,
        ", ub=", ceil((float)sum_of_loss / sum_of_costs_lb), ")");
 }
 
-// for log of map_name
-static const std::regex r_map_name = std::regex(R"(.+/(.+))");
-
 void make_log(const Instance& ins, const Solution& solution,
               const std::string& output_name, const double comp_time_ms,
               const std::string& map_name, const int seed, const bool log_short)
 {
-  // map name
-  std::smatch results;
+  make_log(ins, solution, get_metrics(solution), output_name, comp_time_ms,
+           map_name, seed, log_short);
+}
+
+std::string get_log_meta(const Instance& ins, const Solution& solution,
+                         const Metrics& metrics, const double comp_time_ms,
+                         const std::string& map_name, const int seed)
+{
+  // map name, without directories
+  const auto k = map_name.find_last_of('/');
   const auto map_recorded_name =
-      (std::regex_match(map_name, results, r_map_name)) ? results[1].str()
-                                                        : map_name;
+      (k == std::string::npos || k == 0 || k + 1 == map_name.size())
+          ? map_name
+          : map_name.substr(k + 1);
 
   // for instance-specific values
   auto dist_table = DistTable(ins);
 
-  // log for visualizer
-  auto get_x = [&](int k) { return k % ins.G.width; };
-  auto get_y = [&](int k) { return k / ins.G.width; };
-  std::ofstream log;
-  log.open(output_name, std::ios::out);
+  std::stringstream log;
   log << "agents=" << ins.N << "\n";
   log << "map_file=" << map_recorded_name << "\n";
   log << "solver=planner\n";
   log << "solved=" << !solution.empty() << "\n";
-  log << "soc=" << get_sum_of_costs(solution) << "\n";
-  log << "soc_lb=" << get_sum_of_costs_lower_bound(ins, dist_table) << "\n";
-  log << "makespan=" << get_makespan(solution) << "\n";
+  const auto sum_of_costs_lb = get_sum_of_costs_lower_bound(ins, dist_table);
+  log << "soc=" << metrics.sum_of_costs << "\n";
+  log << "soc_lb=" << sum_of_costs_lb << "\n";
+  log << "makespan=" << metrics.makespan << "\n";
   log << "makespan_lb=" << get_makespan_lower_bound(ins, dist_table) << "\n";
-  log << "sum_of_loss=" << get_sum_of_loss(solution) << "\n";
-  log << "sum_of_loss_lb=" << get_sum_of_costs_lower_bound(ins, dist_table)
-      << "\n";
+  log << "sum_of_loss=" << metrics.sum_of_loss << "\n";
+  log << "sum_of_loss_lb=" << sum_of_costs_lb << "\n";
   log << "comp_time=" << comp_time_ms << "\n";
   log << "seed=" << seed << "\n";
-  if (log_short) return;
-  log << "starts=";
-  for (size_t i = 0; i < ins.N; ++i) {
-    auto k = ins.starts[i]->index;
-    log << "(" << get_x(k) << "," << get_y(k) << "),";
-  }
-  log << "\ngoals=";
-  for (size_t i = 0; i < ins.N; ++i) {
-    auto k = ins.goals[i]->index;
-    log << "(" << get_x(k) << "," << get_y(k) << "),";
-  }
-  log << "\nsolution=\n";
-  for (size_t t = 0; t < solution.size(); ++t) {
-    log << t << ":";
-    auto C = solution[t];
-    for (auto v : C) {
-      log << "(" << get_x(v->index) << "," << get_y(v->index) << "),";
-    }
-    log << "\n";
+#ifdef LACAM_PROFILE
+  log << "profile=" << Profile::to_json() << "\n";
+#endif
+  return log.str();
+}
+
+void make_log(const Instance& ins, const Solution& solution,
+              const Metrics& metrics, const std::string& output_name,
+              const double comp_time_ms, const std::string& map_name,
+              const int seed, const bool log_short, const LogFormat format)
+{
+  const auto log = SolutionLog(
+      ins, solution,
+      get_log_meta(ins, solution, metrics, comp_time_ms, map_name, seed),
+      log_short);
+  if (format == LogFormat::TEXT) {
+    write_text_log(output_name, log);
+  } else {
+    write_solution_file(output_name, log, format == LogFormat::BINARY_RLE);
   }
-  log.close();
 }
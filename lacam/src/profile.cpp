@@ -0,0 +1,80 @@
+#include "../include/profile.hpp"
+
+#include <mutex>
+#include <sstream>
+
+const char* Profile::NAMES[NUM_COUNTERS] = {
+    "expansions",
+    "constraints",
+    "fail_vertex",
+    "fail_swap",
+    "fail_pibt",
+    "pibt_calls",
+    "pibt_max_depth",
+    "bfs_expansions",
+    "closed_hits",
+    "closed_misses",
+    "alloc_bytes",
+    "time_expansion_ns",
+    "time_new_config_ns",
+    "time_bfs_ns",
+};
+
+// counters of finished threads
+static std::mutex total_mtx;
+static Profile total;
+
+struct LocalProfile {
+  Profile profile;
+  ~LocalProfile()
+  {
+    std::lock_guard<std::mutex> lock(total_mtx);
+    total.merge(profile);
+  }
+};
+
+Profile::Profile() : depth(0) { counts.fill(0); }
+
+void Profile::merge(const Profile& other)
+{
+  for (auto k = 0; k < NUM_COUNTERS; ++k) {
+    if (k == PIBT_MAX_DEPTH) {
+      counts[k] = std::max(counts[k], other.counts[k]);
+    } else {
+      counts[k] += other.counts[k];
+    }
+  }
+}
+
+Profile& Profile::local()
+{
+  thread_local LocalProfile local_profile;
+  return local_profile.profile;
+}
+
+Profile Profile::get()
+{
+  std::lock_guard<std::mutex> lock(total_mtx);
+  auto res = total;
+  res.merge(local());
+  return res;
+}
+
+void Profile::reset()
+{
+  std::lock_guard<std::mutex> lock(total_mtx);
+  total.counts.fill(0);
+  local().counts.fill(0);
+}
+
+std::string Profile::to_json()
+{
+  const auto p = get();
+  std::stringstream ss;
+  ss << "{";
+  for (auto k = 0; k < NUM_COUNTERS; ++k) {
+    ss << (k > 0 ? "," : "") << "\"" << NAMES[k] << "\":" << p.counts[k];
+  }
+  ss << "}";
+  return ss.str();
+}
@@ -0,0 +1,191 @@
+#include "../include/solution.hpp"
+
+constexpr size_t Solution::KEYFRAME_INTERVAL;
+
+// minimal bits to represent 0..x
+static int get_bits(uint64_t x)
+{
+  int bits = 1;
+  while (bits < 64 && (x >> bits) > 0) ++bits;
+  return bits;
+}
+
+Solution::Solution(size_t T, const Config& C) : Solution()
+{
+  assign(T, C);
+}
+
+Solution::Solution(std::initializer_list<Config> configs) : Solution()
+{
+  for (auto& C : configs) push_back(C);
+}
+
+Solution::Solution(const std::vector<Config>& configs) : Solution()
+{
+  for (auto& C : configs) push_back(C);
+}
+
+void Solution::clear()
+{
+  G = nullptr;
+  N = 0;
+  packed.clear();
+  num_moves = 0;
+  agent_bits = 0;
+  move_bits = 0;
+  offsets.clear();
+  keyframes.clear();
+  last.clear();
+}
+
+void Solution::assign(size_t T, const Config& C)
+{
+  clear();
+  if (T == 0) return;
+  G = C.G;
+  N = C.size();
+  // without graph, any vertex-id is accepted
+  agent_bits = get_bits(N > 0 ? N - 1 : 0);
+  move_bits = agent_bits + (G != nullptr ? get_bits(G->size()) : 32);
+  offsets.assign(T + 1, 0);
+  for (size_t t = 0; t < T; t += KEYFRAME_INTERVAL) {
+    keyframes.insert(keyframes.end(), C.ids.begin(), C.ids.end());
+  }
+  last = C;
+}
+
+void Solution::push_back(const Config& C)
+{
+  if (empty()) {
+    assign(1, C);
+    return;
+  }
+  if (N == 0 && !C.empty()) assign(size(), C);
+  if (C.G != nullptr) G = C.G;
+  for (size_t i = 0; i < N; ++i) {
+    if (C.ids[i] != last.ids[i]) {
+      push_move(Move{(uint32_t)i, C.ids[i]});
+      last.ids[i] = C.ids[i];
+    }
+  }
+  last.G = G;
+  close_timestep();
+}
+
+void Solution::push_moves(const std::vector<Move>& moves)
+{
+  for (auto& m : moves) {
+    push_move(m);
+    last.ids[m.agent] = m.to;
+  }
+  close_timestep();
+}
+
+void Solution::close_timestep()
+{
+  offsets.push_back(num_moves);
+  if ((size() - 1) % KEYFRAME_INTERVAL == 0) {
+    keyframes.insert(keyframes.end(), last.ids.begin(), last.ids.end());
+  }
+}
+
+void Solution::apply(size_t t, Config& C) const
+{
+  for (auto k = offsets[t]; k < offsets[t + 1]; ++k) {
+    const auto m = get_move(k);
+    C.ids[m.agent] = m.to;
+  }
+}
+
+void Solution::push_move(const Move& m)
+{
+  const uint64_t x = m.agent | (uint64_t)(uint32_t)(m.to + 1) << agent_bits;
+  const auto pos = num_moves * move_bits;
+  const auto w = pos >> 6;
+  const auto off = pos & 63;
+  while (packed.size() <= (pos + move_bits) >> 6) packed.push_back(0);
+  packed[w] |= x << off;
+  if (off + move_bits > 64) packed[w + 1] |= x >> (64 - off);
+  ++num_moves;
+}
+
+Config Solution::get(size_t t) const
+{
+  const auto t_key = t - t % KEYFRAME_INTERVAL;
+  const auto key = keyframes.begin() + t_key / KEYFRAME_INTERVAL * N;
+  Config C;
+  C.ids.assign(key, key + N);
+  C.G = G;
+  for (auto s = t_key + 1; s <= t; ++s) apply(s, C);
+  return C;
+}
+
+Vertex* Solution::get(size_t t, size_t i) const
+{
+  const auto t_key = t - t % KEYFRAME_INTERVAL;
+  // the latest move of agent-i after the keyframe
+  for (auto k = offsets[t + 1]; k > offsets[t_key + 1]; --k) {
+    const auto m = get_move(k - 1);
+    if (m.agent == i) return m.to == Config::NONE ? nullptr : G->V[m.to];
+  }
+  const auto v = keyframes[t_key / KEYFRAME_INTERVAL * N + i];
+  return v == Config::NONE ? nullptr : G->V[v];
+}
+
+void Solution::set(size_t t, const Config& C)
+{
+  if (N == 0 && !C.empty()) assign(size(), C);
+  if (C.G != nullptr) G = C.G;
+  const auto T = size();
+
+  // moves from the previous configuration and to the next one
+  auto diff = [&](const Config& C_from, const Config& C_to,
+                  std::vector<Move>& res) {
+    for (size_t i = 0; i < N; ++i) {
+      if (C_from.ids[i] != C_to.ids[i]) {
+        res.push_back(Move{(uint32_t)i, C_to.ids[i]});
+      }
+    }
+  };
+  std::vector<Move> moves_new;
+  if (t > 0) diff(get(t - 1), C, moves_new);
+  const auto k = moves_new.size();
+  if (t + 1 < T) diff(C, get(t + 1), moves_new);
+
+  // replace moves at t and t+1, later offsets are shifted
+  const auto t_end = std::min(t + 2, T);
+  std::vector<Move> moves;
+  for (size_t l = 0; l < num_moves; ++l) moves.push_back(get_move(l));
+  const auto it = moves.erase(moves.begin() + offsets[t],
+                              moves.begin() + offsets[t_end]);
+  moves.insert(it, moves_new.begin(), moves_new.end());
+  const auto shift = (int64_t)(offsets[t] + moves_new.size()) -
+                     (int64_t)offsets[t_end];
+  for (auto s = t_end; s <= T; ++s) offsets[s] += shift;
+  offsets[t + 1] = offsets[t] + k;
+  packed.clear();
+  num_moves = 0;
+  for (auto& m : moves) push_move(m);
+
+  if (t % KEYFRAME_INTERVAL == 0) {
+    std::copy(C.ids.begin(), C.ids.end(),
+              keyframes.begin() + t / KEYFRAME_INTERVAL * N);
+  }
+  if (t + 1 == T) {
+    last = C;
+    last.G = G;
+  }
+}
+
+Solution::Iterator Solution::begin() const
+{
+  if (empty()) return end();
+  return Iterator{this, 0, get(0)};
+}
+
+size_t Solution::memory() const
+{
+  return packed.capacity() * sizeof(uint64_t) +
+         offsets.capacity() * sizeof(uint32_t) +
+         (keyframes.capacity() + last.ids.capacity()) * sizeof(uint32_t);
+}
@@ -0,0 +1,353 @@
+#include "../include/solution_file.hpp"
+
+#include <charconv>
+#include <cstring>
+
+constexpr char SolutionLog::MAGIC[8];
+constexpr uint32_t SolutionLog::VERSION;
+constexpr uint32_t SolutionLog::FLG_RLE;
+constexpr uint32_t SolutionLog::FLG_SHORT;
+
+SolutionLog::SolutionLog(const Instance& ins, const Solution& _solution,
+                         const std::string& _meta, const bool _log_short)
+    : width(ins.G.width),
+      height(ins.G.height),
+      log_short(_log_short),
+      meta(_meta),
+      source(nullptr)
+{
+  if (log_short) return;
+  for (auto v : ins.starts) starts.push_back(v->index);
+  for (auto v : ins.goals) goals.push_back(v->index);
+  source = &_solution;
+}
+
+bool SolutionLog::is_valid() const { return width >= 0; }
+
+size_t SolutionLog::size() const
+{
+  return source != nullptr ? source->size() : solution.size();
+}
+
+void SolutionLog::for_each(
+    const std::function<void(size_t, const std::vector<int>&)>& f) const
+{
+  if (source == nullptr) {
+    for (size_t t = 0; t < solution.size(); ++t) f(t, solution[t]);
+    return;
+  }
+  if (source->empty()) return;  // without graph
+  // one configuration at a time, by applying moves
+  const auto& V = source->G->V;
+  std::vector<int> C;
+  size_t t = 0;
+  for (auto& config : *source) {
+    C.resize(config.size());
+    for (size_t i = 0; i < C.size(); ++i) C[i] = V[config.ids[i]]->index;
+    f(t++, C);
+  }
+}
+
+// minimal bits to represent 0..x
+static uint32_t get_bits(uint64_t x)
+{
+  uint32_t bits = 1;
+  while (bits < 64 && (x >> bits) > 0) ++bits;
+  return bits;
+}
+
+// buffered, whole words are flushed to the file
+struct BitWriter {
+  static constexpr size_t BUF_WORDS = 8192;
+  std::ofstream& file;
+  std::vector<uint64_t> buf;
+  uint64_t acc;
+  int acc_bits;
+  uint64_t words;  // written to the file
+
+  BitWriter(std::ofstream& _file) : file(_file), acc(0), acc_bits(0), words(0)
+  {
+    buf.reserve(BUF_WORDS);
+  }
+
+  void put(const uint64_t x, const int bits)
+  {
+    acc |= x << acc_bits;
+    if (acc_bits + bits < 64) {
+      acc_bits += bits;
+      return;
+    }
+    push(acc);
+    acc = acc_bits > 0 ? x >> (64 - acc_bits) : 0;
+    acc_bits = acc_bits + bits - 64;
+  }
+
+  void push(const uint64_t w)
+  {
+    buf.push_back(w);
+    if (buf.size() == BUF_WORDS) flush();
+  }
+
+  void flush()
+  {
+    file.write((const char*)buf.data(), buf.size() * sizeof(uint64_t));
+    words += buf.size();
+    buf.clear();
+  }
+
+  void finish()
+  {
+    if (acc_bits > 0) push(acc);
+    acc = 0;
+    acc_bits = 0;
+    flush();
+  }
+};
+
+struct BitReader {
+  const uint64_t* words;
+  const uint64_t num_words;
+  uint64_t pos;  // in bits
+
+  BitReader(const uint64_t* _words, uint64_t _num_words)
+      : words(_words), num_words(_num_words), pos(0)
+  {
+  }
+
+  bool has(const int bits) const { return pos + bits <= num_words * 64; }
+
+  uint64_t get(const int bits)
+  {
+    const auto k = pos >> 6;
+    const auto off = pos & 63;
+    auto x = words[k] >> off;
+    if (off + bits > 64) x |= words[k + 1] << (64 - off);
+    pos += bits;
+    return bits == 64 ? x : x & ((uint64_t(1) << bits) - 1);
+  }
+};
+
+bool write_solution_file(const std::string& filename, const SolutionLog& log,
+                         const bool rle)
+{
+  auto header = SolutionFileHeader();
+  std::memcpy(header.magic, SolutionLog::MAGIC, sizeof(SolutionLog::MAGIC));
+  header.version = SolutionLog::VERSION;
+  header.flags = (rle ? SolutionLog::FLG_RLE : 0) |
+                 (log.log_short ? SolutionLog::FLG_SHORT : 0);
+  header.width = log.width;
+  header.height = log.height;
+  header.num_agents = log.starts.size();
+  header.num_timesteps = log.size();
+  header.vertex_bits = get_bits((uint64_t)log.width * log.height);
+  header.run_bits = get_bits(log.size());
+  header.meta_size = log.meta.size();
+  header.body_words = 0;
+
+  std::ofstream file(filename, std::ios::out | std::ios::binary);
+  if (!file) {
+    info(0, 0, "failed to open ", filename);
+    return false;
+  }
+  file.write((const char*)&header, sizeof(header));
+  file.write(log.meta.data(), log.meta.size());
+  const char pad[8] = {0};
+  file.write(pad, (8 - log.meta.size() % 8) % 8);
+
+  const int N = header.num_agents;
+  const int bits = header.vertex_bits;
+  auto writer = BitWriter(file);
+  for (auto k : log.starts) writer.put(k, bits);
+  for (auto k : log.goals) writer.put(k, bits);
+  if (!rle) {
+    log.for_each([&](size_t, const std::vector<int>& C) {
+      for (auto k : C) writer.put(k, bits);
+    });
+  } else {
+    // runs of each agent, waiting is a single run
+    // collected timestep by timestep, i.e., proportional to moves
+    std::vector<std::vector<std::pair<int, int> > > runs(N);
+    log.for_each([&](size_t, const std::vector<int>& C) {
+      for (auto i = 0; i < N; ++i) {
+        auto& r = runs[i];
+        if (r.empty() || r.back().first != C[i]) {
+          r.emplace_back(C[i], 1);
+        } else {
+          ++r.back().second;
+        }
+      }
+    });
+    for (auto& r : runs) {
+      writer.put(r.size(), header.run_bits);
+      for (auto& run : r) {
+        writer.put(run.first, bits);
+        writer.put(run.second, header.run_bits);
+      }
+    }
+  }
+  writer.finish();
+
+  // body size, known after encoding
+  header.body_words = writer.words;
+  file.seekp(0);
+  file.write((const char*)&header, sizeof(header));
+  return file.good();
+}
+
+// count x bits_each <= budget, without overflow
+static bool fits(const uint64_t count, const uint64_t bits_each,
+                 const uint64_t budget)
+{
+  return bits_each == 0 || count <= budget / bits_each;
+}
+
+SolutionLog read_solution_file(const std::string& filename)
+{
+  SolutionLog log;
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  if (!file) {
+    info(0, 0, "file ", filename, " is not found.");
+    return log;
+  }
+  file.seekg(0, std::ios::end);
+  const uint64_t file_size = file.tellg();
+  file.seekg(0);
+  auto header = SolutionFileHeader();
+  file.read((char*)&header, sizeof(header));
+  if (!file || std::memcmp(header.magic, SolutionLog::MAGIC, 8) != 0 ||
+      header.version != SolutionLog::VERSION || header.vertex_bits == 0 ||
+      header.vertex_bits > 32 || header.run_bits == 0 ||
+      header.run_bits > 32 || header.num_agents > INT_MAX ||
+      header.num_timesteps > INT_MAX || header.width == 0 ||
+      header.width > INT_MAX || header.height > INT_MAX) {
+    info(0, 0, filename, " is not a valid solution file");
+    return log;
+  }
+
+  // sizes in the header must match the file before any allocation
+  const int N = header.num_agents;
+  const int T = header.num_timesteps;
+  const int bits = header.vertex_bits;
+  const int run_bits = header.run_bits;
+  const bool rle = header.flags & SolutionLog::FLG_RLE;
+  const uint64_t rest = file_size - sizeof(header);
+  const uint64_t meta_bytes =
+      header.meta_size <= rest ? (header.meta_size + 7) / 8 * 8 : rest + 1;
+  const uint64_t body_bits = header.body_words * 64;
+  auto corrupted = [&]() {
+    info(0, 0, filename, " is corrupted");
+    return SolutionLog();
+  };
+  if (meta_bytes > rest || header.body_words != (rest - meta_bytes) / 8 ||
+      (rest - meta_bytes) % 8 != 0) {
+    info(0, 0, filename, " is truncated");
+    return SolutionLog();
+  }
+  // starts, goals, then at least T x N vertices, or one run per agent
+  // run lengths up to T are stored in run_bits
+  if (!fits((uint64_t)N * 2, bits, body_bits) ||
+      (!rle && !fits((uint64_t)N * (T + 2), bits, body_bits)) ||
+      (rle && !fits(N, bits * (T > 0 ? 3 : 2) + run_bits * (T > 0 ? 2 : 1),
+                    body_bits)) ||
+      (rle && (T >> run_bits) > 0)) {
+    return corrupted();
+  }
+
+  log.meta.resize(header.meta_size);
+  file.read(&log.meta[0], header.meta_size);
+  file.ignore(meta_bytes - header.meta_size);
+  std::vector<uint64_t> words(header.body_words);
+  file.read((char*)words.data(), words.size() * sizeof(uint64_t));
+  if (!file) {
+    info(0, 0, filename, " is truncated");
+    return SolutionLog();
+  }
+
+  auto reader = BitReader(words.data(), words.size());
+  log.starts.resize(N);
+  log.goals.resize(N);
+  for (auto& k : log.starts) k = reader.get(bits);
+  for (auto& k : log.goals) k = reader.get(bits);
+  if (!rle) {
+    log.solution.assign(T, std::vector<int>(N));
+    for (auto& C : log.solution) {
+      for (auto& k : C) k = reader.get(bits);
+    }
+  } else {
+    // runs are checked before expanding them into T x N
+    std::vector<std::pair<int, int> > runs;  // vertex index, length
+    std::vector<size_t> runs_offsets(1, 0);  // index: agent
+    for (auto i = 0; i < N; ++i) {
+      if (!reader.has(run_bits)) return corrupted();
+      const auto num_runs = reader.get(run_bits);
+      int t = 0;
+      for (uint64_t r = 0; r < num_runs; ++r) {
+        if (!reader.has(bits + run_bits)) return corrupted();
+        const int k = reader.get(bits);
+        const int len = reader.get(run_bits);
+        if (t + len > T) return corrupted();
+        runs.emplace_back(k, len);
+        t += len;
+      }
+      if (t != T) return corrupted();
+      runs_offsets.push_back(runs.size());
+    }
+    log.solution.assign(T, std::vector<int>(N));
+    for (auto i = 0; i < N; ++i) {
+      int t = 0;
+      for (auto r = runs_offsets[i]; r < runs_offsets[i + 1]; ++r) {
+        for (auto l = 0; l < runs[r].second; ++l) {
+          log.solution[t++][i] = runs[r].first;
+        }
+      }
+    }
+  }
+  log.width = header.width;
+  log.height = header.height;
+  log.log_short = header.flags & SolutionLog::FLG_SHORT;
+  return log;
+}
+
+bool write_text_log(const std::string& filename, const SolutionLog& log)
+{
+  std::ofstream file(filename, std::ios::out);
+  if (!file) {
+    info(0, 0, "failed to open ", filename);
+    return false;
+  }
+  file << log.meta;
+  if (log.log_short) return file.good();
+
+  // formatted in a buffer, streams are slow for many small writes
+  std::string buf;
+  char num[16];
+  auto put_int = [&](int x) {
+    auto res = std::to_chars(num, num + sizeof(num), x);
+    buf.append(num, res.ptr);
+  };
+  auto put_vertex = [&](int k) {
+    buf += '(';
+    put_int(k % log.width);
+    buf += ',';
+    put_int(k / log.width);
+    buf += "),";
+  };
+  auto flush = [&]() {
+    file.write(buf.data(), buf.size());
+    buf.clear();
+  };
+  buf += "starts=";
+  for (auto k : log.starts) put_vertex(k);
+  buf += "\ngoals=";
+  for (auto k : log.goals) put_vertex(k);
+  buf += "\nsolution=\n";
+  log.for_each([&](size_t t, const std::vector<int>& C) {
+    put_int(t);
+    buf += ':';
+    for (auto k : C) put_vertex(k);
+    buf += '\n';
+    if (buf.size() > (1 << 20)) flush();
+  });
+  flush();
+  return file.good();
+}
@@ -1,5 +1,12 @@
 #include "../include/utils.hpp"
 
+#include "../include/profile.hpp"
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <thread>
+
 void info(const int level, const int verbose) { std::cout << std::endl; }
 
 Deadline::Deadline(double _time_limit_ms)
@@ -38,8 +45,103 @@ bool is_expired(const Deadline* deadline)
   return deadline->elapsed_ms() > deadline->time_limit_ms;
 }
 
+bool read_file(const std::string& filename, std::string& buf)
+{
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  if (!file) return false;
+  file.seekg(0, std::ios::end);
+  buf.resize(file.tellg());
+  file.seekg(0, std::ios::beg);
+  file.read(buf.data(), buf.size());
+  return true;
+}
+
+bool next_line(const std::string& buf, size_t& pos, std::string_view& line)
+{
+  if (pos >= buf.size()) return false;
+  auto end = buf.find('\n', pos);
+  if (end == std::string::npos) end = buf.size();
+  line = std::string_view(buf.data() + pos, end - pos);
+  pos = end + 1;
+  // for CRLF coding
+  if (!line.empty() && line.back() == 0x0d) line.remove_suffix(1);
+  return true;
+}
+
+bool parse_uint(std::string_view s, int& x)
+{
+  if (s.empty()) return false;
+  x = 0;
+  for (auto c : s) {
+    if (c < '0' || '9' < c) return false;
+    x = x * 10 + (c - '0');
+  }
+  return true;
+}
+
 float get_random_float(std::mt19937* MT, float from, float to)
 {
   std::uniform_real_distribution<float> r(from, to);
   return r(*MT);
 }
+
+int get_random_int(std::mt19937* MT, int from, int to)
+{
+  std::uniform_int_distribution<int> r(from, to);
+  return r(*MT);
+}
+
+size_t get_peak_rss()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return (size_t)usage.ru_maxrss * 1024;  // KB on Linux
+}
+
+void parallel_for(const size_t n, const std::function<void(size_t)>& f,
+                  const int threads)
+{
+  size_t num = threads > 0 ? threads : std::thread::hardware_concurrency();
+  num = std::min(std::max(num, (size_t)1), n);
+  if (num <= 1) {
+    for (size_t k = 0; k < n; ++k) f(k);
+    return;
+  }
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (auto k = next++; k < n; k = next++) f(k);
+  };
+  std::vector<std::thread> pool;
+  for (size_t j = 1; j < num; ++j) pool.emplace_back(worker);
+  worker();
+  for (auto& th : pool) th.join();
+}
+
+Arena::Arena(size_t _chunk_size)
+    : chunk_size(_chunk_size), chunks(), used(_chunk_size), allocated(0)
+{
+}
+
+Arena::~Arena() { release(); }
+
+void* Arena::allocate(size_t size, size_t align)
+{
+  auto offset = (used + align - 1) / align * align;
+  if (offset + size > chunk_size) {
+    // objects larger than chunk_size get their own chunk
+    chunks.push_back(new char[std::max(size, chunk_size)]);
+    offset = 0;
+  }
+  used = offset + size;
+  allocated += size;
+  PROFILE_ADD(ALLOC_BYTES, size);
+  return chunks.back() + offset;
+}
+
+void Arena::release()
+{
+  for (auto p : chunks) delete[] p;
+  chunks.clear();
+  used = chunk_size;
+  allocated = 0;
+}
@@ -1,8 +1,197 @@
 #include <argparse/argparse.hpp>
 #include <lacam.hpp>
 
+// subcommand, save distance fields of goals for later runs
+int precompute(int argc, char* argv[])
+{
+  argparse::ArgumentParser program("lacam precompute", "0.1.0");
+  program.add_argument("-m", "--map").help("map file").required();
+  program.add_argument("-i", "--scen")
+      .help("scenario file, goals of the first N agents")
+      .required();
+  program.add_argument("-N", "--num")
+      .help("number of agents")
+      .default_value(std::string("1000000"));
+  program.add_argument("-o", "--output").help("output file").required();
+
+  try {
+    program.parse_known_args(argc, argv);
+  } catch (const std::runtime_error& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    std::exit(1);
+  }
+
+  const auto map_name = program.get<std::string>("map");
+  const auto scen_name = program.get<std::string>("scen");
+  const auto output_name = program.get<std::string>("output");
+  const auto N = std::stoi(program.get<std::string>("num"));
+  const auto deadline = Deadline();
+  const auto ins = Instance(scen_name, map_name, N);
+  if (!write_dist_file(output_name, ins.G, ins.goals)) return 1;
+  info(0, 0, "elapsed:", elapsed_ms(&deadline), "ms\tsaved ", output_name);
+  return 0;
+}
+
+// subcommand, solve many jobs listed in a manifest
+int batch(int argc, char* argv[])
+{
+  argparse::ArgumentParser program("lacam batch", "0.1.0");
+  program.add_argument("-b", "--manifest")
+      .help("job list, one \"map scen N seed [time_limit_sec]\" per line")
+      .required();
+  program.add_argument("-j", "--threads")
+      .help("number of worker threads, 0 -> all cores")
+      .default_value(std::string("0"));
+  program.add_argument("-t", "--time_limit_sec")
+      .help("default time limit sec")
+      .default_value(std::string("10"));
+  program.add_argument("-v", "--verbose")
+      .help("verbose")
+      .default_value(std::string("1"));
+  program.add_argument("-o", "--output")
+      .help("output file, one record per job")
+      .default_value(std::string("./build/result_batch.txt"));
+  program.add_argument("-e", "--eager_dist_table")
+      .help("compute distance tables for all goals up front, in parallel")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("-c", "--dist_cache_mb")
+      .help("memory budget of distance fields shared among jobs, 0 -> off")
+      .default_value(std::string("0"));
+
+  try {
+    program.parse_known_args(argc, argv);
+  } catch (const std::runtime_error& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    std::exit(1);
+  }
+
+  const auto verbose = std::stoi(program.get<std::string>("verbose"));
+  const auto threads = std::stoi(program.get<std::string>("threads"));
+  const auto time_limit_sec =
+      std::stoi(program.get<std::string>("time_limit_sec"));
+  const auto output_name = program.get<std::string>("output");
+  DistTable::FLG_EAGER = program.get<bool>("eager_dist_table");
+  DistCache::get_instance().set_budget(
+      std::stoul(program.get<std::string>("dist_cache_mb")) << 20);
+
+  const auto manifest_name = program.get<std::string>("manifest");
+  const auto jobs = load_manifest(manifest_name, time_limit_sec * 1000);
+  std::ofstream output(output_name, std::ios::out);
+  if (!output) {
+    info(0, verbose, "failed to open ", output_name);
+    return 1;
+  }
+  solve_batch(jobs, output, threads, verbose);
+  return 0;
+}
+
+// subcommand, synthesize a map and optionally a scenario on it
+int generate(int argc, char* argv[])
+{
+  argparse::ArgumentParser program("lacam generate", "0.1.0");
+  program.add_argument("-t", "--type")
+      .help("random, warehouse, maze, or room")
+      .default_value(std::string("random"));
+  program.add_argument("-W", "--width").default_value(std::string("256"));
+  program.add_argument("-H", "--height").default_value(std::string("256"));
+  program.add_argument("-r", "--obstacle_ratio")
+      .help("random map")
+      .default_value(std::string("0.1"));
+  program.add_argument("-k", "--size")
+      .help("corridor width of maze, room size of room, shelf width of "
+            "warehouse")
+      .default_value(std::string("0"));
+  program.add_argument("-N", "--num")
+      .help("number of agents, 0 -> no scenario")
+      .default_value(std::string("0"));
+  program.add_argument("-d", "--density")
+      .help("agents per free cell, used when N is 0")
+      .default_value(std::string("0"));
+  program.add_argument("-s", "--seed").default_value(std::string("0"));
+  program.add_argument("-o", "--output").help("map file").required();
+  program.add_argument("-i", "--scen")
+      .help("scenario file")
+      .default_value(std::string(""));
+
+  try {
+    program.parse_known_args(argc, argv);
+  } catch (const std::runtime_error& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    std::exit(1);
+  }
+
+  const auto type = program.get<std::string>("type");
+  const auto width = std::stoi(program.get<std::string>("width"));
+  const auto height = std::stoi(program.get<std::string>("height"));
+  const auto ratio = std::stof(program.get<std::string>("obstacle_ratio"));
+  const auto size = std::stoi(program.get<std::string>("size"));
+  const auto density = std::stof(program.get<std::string>("density"));
+  auto N = std::stoi(program.get<std::string>("num"));
+  auto MT = std::mt19937(std::stoi(program.get<std::string>("seed")));
+  const auto map_name = program.get<std::string>("output");
+  const auto scen_name = program.get<std::string>("scen");
+  const auto deadline = Deadline();
+
+  const auto map =
+      type == "warehouse" ? make_warehouse_map(width, height,
+                                               size > 0 ? size : 10)
+      : type == "maze"    ? make_maze_map(width, height, size > 0 ? size : 2,
+                                          0.1, &MT)
+      : type == "room"    ? make_room_map(width, height, size > 0 ? size : 16,
+                                          &MT)
+                          : make_random_map(width, height, ratio, &MT);
+  if (!map.save(map_name)) return 1;
+  if (N == 0) N = density * map.count_free();
+  if (N > 0 && !scen_name.empty()) {
+    const auto ins = Instance(map_name, &MT, N);
+    if (!ins.is_valid(1) || !save_scen(scen_name, map_name, ins)) return 1;
+  }
+  info(0, 0, "elapsed:", elapsed_ms(&deadline), "ms	saved ", map_name,
+       "	free cells:", map.count_free(), "	agents:", N);
+  return 0;
+}
+
+// subcommand, binary solution log back to the text one for the visualizer
+int convert(int argc, char* argv[])
+{
+  argparse::ArgumentParser program("lacam convert", "0.1.0");
+  program.add_argument("-i", "--input").help("binary log file").required();
+  program.add_argument("-o", "--output").help("text log file").required();
+
+  try {
+    program.parse_known_args(argc, argv);
+  } catch (const std::runtime_error& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    std::exit(1);
+  }
+
+  const auto input_name = program.get<std::string>("input");
+  const auto output_name = program.get<std::string>("output");
+  const auto log = read_solution_file(input_name);
+  if (!log.is_valid() || !write_text_log(output_name, log)) return 1;
+  return 0;
+}
+
 int main(int argc, char* argv[])
 {
+  if (argc > 1 && std::string(argv[1]) == "precompute") {
+    return precompute(argc - 1, argv + 1);
+  }
+  if (argc > 1 && std::string(argv[1]) == "batch") {
+    return batch(argc - 1, argv + 1);
+  }
+  if (argc > 1 && std::string(argv[1]) == "generate") {
+    return generate(argc - 1, argv + 1);
+  }
+  if (argc > 1 && std::string(argv[1]) == "convert") {
+    return convert(argc - 1, argv + 1);
+  }
+
   // arguments parser
   argparse::ArgumentParser program("lacam", "0.1.0");
   program.add_argument("-m", "--map").help("map file").required();
@@ -25,6 +214,34 @@ int main(int argc, char* argv[])
   program.add_argument("-l", "--log_short")
       .default_value(false)
       .implicit_value(true);
+  program.add_argument("-F", "--log_format")
+      .help("text, binary, or binary_rle; see the convert subcommand")
+      .default_value(std::string("text"));
+  program.add_argument("-e", "--eager_dist_table")
+      .help("compute distance tables for all goals up front, in parallel")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("-c", "--dist_cache_mb")
+      .help("memory budget of distance fields shared among tables, 0 -> off")
+      .default_value(std::string("0"));
+  program.add_argument("-f", "--dist_file")
+      .help("precomputed distance fields, see the precompute subcommand")
+      .default_value(std::string(""));
+  program.add_argument("-p", "--portfolio")
+      .help("number of planners racing with different seeds, 1 -> off")
+      .default_value(std::string("1"));
+  program.add_argument("-j", "--threads")
+      .help("number of threads sharing one search, 1 -> off")
+      .default_value(std::string("1"));
+  program.add_argument("-M", "--memory_mb")
+      .help("memory budget of search data, spilled to disk beyond, 0 -> off")
+      .default_value(std::string("0"));
+  program.add_argument("-a", "--anytime")
+      .help(
+          "keep refining sum_of_loss until the time limit, single planner "
+          "only, i.e., not with -p or -j")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_known_args(argc, argv);
@@ -44,14 +261,43 @@ int main(int argc, char* argv[])
   const auto map_name = program.get<std::string>("map");
   const auto output_name = program.get<std::string>("output");
   const auto log_short = program.get<bool>("log_short");
+  const auto log_format_name = program.get<std::string>("log_format");
+  const auto log_format =
+      log_format_name == "binary"       ? LogFormat::BINARY
+      : log_format_name == "binary_rle" ? LogFormat::BINARY_RLE
+                                        : LogFormat::TEXT;
   const auto N = std::stoi(program.get<std::string>("num"));
+  const auto portfolio = std::stoi(program.get<std::string>("portfolio"));
+  const auto threads = std::stoi(program.get<std::string>("threads"));
+  if (program.get<bool>("anytime") && (portfolio > 1 || threads > 1)) {
+    std::cerr << "--anytime is not supported with --portfolio or --threads"
+              << std::endl;
+    return 1;
+  }
+  DistTable::FLG_EAGER = program.get<bool>("eager_dist_table");
+  Planner::FLG_ANYTIME = program.get<bool>("anytime");
+  Planner::MEMORY_BUDGET = std::stoul(program.get<std::string>("memory_mb"))
+                           << 20;
+  DistCache::get_instance().set_budget(
+      std::stoul(program.get<std::string>("dist_cache_mb")) << 20);
+  const auto dist_file_name = program.get<std::string>("dist_file");
+  if (!dist_file_name.empty()) {
+    auto file = std::make_shared<const DistFile>(dist_file_name);
+    if (!file->is_valid()) return 1;
+    DistCache::get_instance().attach(file);
+  }
   const auto ins = scen_name.size() > 0 ? Instance(scen_name, map_name, N)
                                         : Instance(map_name, &MT, N);
   if (!ins.is_valid(1)) return 1;
 
   // solve
   const auto deadline = Deadline(time_limit_sec * 1000);
-  const auto solution = solve(ins, verbose - 1, &deadline, &MT);
+  Metrics metrics;  // tracked by solve, otherwise computed afterward
+  const auto solution =
+      portfolio > 1 ? solve_portfolio(ins, portfolio, verbose - 1, &deadline,
+                                      seed)
+      : threads > 1 ? solve_parallel(ins, threads, verbose - 1, &deadline, seed)
+                    : solve(ins, verbose - 1, &deadline, &MT, &metrics);
   const auto comp_time_ms = deadline.elapsed_ms();
 
   // failure
@@ -64,7 +310,9 @@ int main(int argc, char* argv[])
   }
 
   // post processing
-  print_stats(verbose, ins, solution, comp_time_ms);
-  make_log(ins, solution, output_name, comp_time_ms, map_name, seed, log_short);
+  if (portfolio > 1 || threads > 1) metrics = get_metrics(solution);
+  print_stats(verbose, ins, metrics, comp_time_ms);
+  make_log(ins, solution, metrics, output_name, comp_time_ms, map_name, seed,
+           log_short, log_format);
   return 0;
 }
@@ -0,0 +1,25 @@
+#include <lacam.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(batch, solve)
+{
+  const auto filename = testing::TempDir() + "manifest.txt";
+  std::ofstream(filename)
+      << "# map scen N seed\n"
+      << "./assets/random-32-32-10.map "
+      << "./assets/random-32-32-10-random-1.scen 10 0\n"
+      << "./assets/random-32-32-10.map - 20 1 5\n"
+      << "./tests/assets/2x1.map ./tests/assets/2x1.scen 2 0\n"
+      << "invalid line\n";
+  const auto jobs = load_manifest(filename, 1000);
+  ASSERT_EQ(jobs.size(), 3);
+  ASSERT_EQ(jobs[1].scen_name, "");
+  ASSERT_EQ(jobs[1].time_limit_ms, 5000);
+
+  std::ostringstream os;
+  ASSERT_EQ(solve_batch(jobs, os, 2), 2);
+  const auto output = os.str();
+  ASSERT_EQ(std::count(output.begin(), output.end(), '\n'), 3);
+  ASSERT_NE(output.find("job=2\t"), std::string::npos);
+}
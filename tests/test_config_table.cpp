@@ -0,0 +1,130 @@
+#include <lacam.hpp>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+TEST(ConfigTable, insert_and_find)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 3);
+  auto CLOSED = ConfigTable(&ins.G, ins.N);
+  ASSERT_EQ(CLOSED.id_bytes, 2);
+
+  auto res = CLOSED.insert(ins.starts);
+  ASSERT_TRUE(res.second);
+  ASSERT_EQ(res.first, 0);
+  ASSERT_EQ(CLOSED.find(ins.goals), -1);
+
+  res = CLOSED.insert(ins.goals);
+  ASSERT_TRUE(res.second);
+  ASSERT_EQ(res.first, 1);
+
+  // duplicates
+  res = CLOSED.insert(ins.starts);
+  ASSERT_FALSE(res.second);
+  ASSERT_EQ(res.first, 0);
+  ASSERT_EQ(CLOSED.find(ins.goals), 1);
+  ASSERT_EQ(CLOSED.size(), 2);
+
+  // decode
+  ASSERT_EQ(CLOSED.get(1, 0), ins.goals[0]);
+  Config C;
+  CLOSED.unpack(0, C);
+  ASSERT_TRUE(is_same_config(C, ins.starts));
+  ASSERT_TRUE(CLOSED.is_same(1, ins.goals));
+  ASSERT_FALSE(CLOSED.is_same(0, ins.goals));
+
+  // moves between packed configurations
+  auto C_moved = ins.starts;
+  C_moved[1] = ins.goals[1];
+  ASSERT_EQ(CLOSED.insert(C_moved).first, 2);
+  std::vector<Solution::Move> moves;
+  ASSERT_TRUE(CLOSED.get_moves(0, 2, moves));
+  ASSERT_EQ(moves.size(), 1);
+  ASSERT_EQ(moves[0].agent, 1);
+  ASSERT_EQ(moves[0].to, ins.goals[1]->id);
+  ASSERT_TRUE(CLOSED.get_moves(0, 0, moves));
+  ASSERT_TRUE(moves.empty());
+  auto solution = Solution({ins.starts});
+  ASSERT_TRUE(CLOSED.get_moves(0, 1, moves));
+  solution.push_moves(moves);
+  ASSERT_EQ(solution.size(), 2);
+  ASSERT_TRUE(is_same_config(solution[1], ins.goals));
+  ASSERT_EQ(solution.num_moves, moves.size());
+}
+
+TEST(ConfigTable, rehash)
+{
+  const auto map_filename = "./assets/random-32-32-10.map";
+  auto G = Graph(map_filename);
+  auto CLOSED = ConfigTable(&G, 2);
+
+  // more configurations than the initial slots
+  for (int i = 0; i < G.size(); ++i) {
+    for (int j = 0; j < 4; ++j) {
+      auto res = CLOSED.insert(Config({G.V[i], G.V[j]}));
+      ASSERT_TRUE(res.second);
+    }
+  }
+  ASSERT_EQ(CLOSED.size(), G.size() * 4);
+  ASSERT_EQ(CLOSED.find(Config({G.V[100], G.V[3]})), 100 * 4 + 3);
+}
+
+TEST(ConfigTable, spill)
+{
+  const auto map_filename = "./assets/random-32-32-10.map";
+  auto G = Graph(map_filename);
+  auto CLOSED = ConfigTable(&G, 2);
+  for (int i = 0; i < G.size(); ++i) {
+    for (int j = 0; j < 4; ++j) CLOSED.insert(Config({G.V[i], G.V[j]}));
+  }
+  const auto bytes = CLOSED.bytes();
+  ASSERT_GT(CLOSED.spill(1), 0);
+  ASSERT_EQ(CLOSED.spilled_chunks, 1);
+  ASSERT_LT(CLOSED.bytes(), bytes);
+
+  // spilled configurations are read back
+  ASSERT_EQ(CLOSED.find(Config({G.V[100], G.V[3]})), 100 * 4 + 3);
+  ASSERT_EQ(CLOSED.get(5, 0), G.V[1]);
+  ASSERT_TRUE(CLOSED.is_same(2, Config({G.V[0], G.V[2]})));
+  ASSERT_FALSE(CLOSED.insert(Config({G.V[0], G.V[1]})).second);
+  std::vector<Solution::Move> moves;
+  ASSERT_TRUE(CLOSED.get_moves(1, CLOSED.size() - 1, moves));  // with memory
+  ASSERT_EQ(moves.size(), 2);
+  ASSERT_EQ(moves[0].to, G.V[G.size() - 1]->id);
+  ASSERT_EQ(moves[1].to, G.V[3]->id);
+
+  // the last chunk stays in memory
+  CLOSED.spill(bytes);
+  ASSERT_EQ(CLOSED.spilled_chunks, (int)CLOSED.chunks.size() - 1);
+  ASSERT_EQ(CLOSED.find(Config({G.V[G.size() - 1], G.V[3]})),
+            CLOSED.size() - 1);
+}
+
+TEST(ConfigTable, spill_read_failure)
+{
+  const auto map_filename = "./assets/random-32-32-10.map";
+  auto G = Graph(map_filename);
+  auto CLOSED = ConfigTable(&G, 2);
+  for (int i = 0; i < G.size(); ++i) {
+    for (int j = 0; j < 4; ++j) CLOSED.insert(Config({G.V[i], G.V[j]}));
+  }
+  CLOSED.spill(CLOSED.bytes());
+  ASSERT_FALSE(CLOSED.read_failed);
+
+  // lose the spilled chunks, reads report errors instead of aborting
+  ASSERT_EQ(ftruncate(fileno(CLOSED.spill_file.get()), 0), 0);
+  auto C = Config();
+  ASSERT_FALSE(CLOSED.unpack(5, C));
+  ASSERT_TRUE(CLOSED.read_failed);
+  ASSERT_EQ(CLOSED.get(5, 0), nullptr);
+  ASSERT_FALSE(CLOSED.is_same(2, Config({G.V[0], G.V[2]})));
+  ASSERT_EQ(CLOSED.find(Config({G.V[100], G.V[3]})), -1);
+  std::vector<Solution::Move> moves;
+  ASSERT_FALSE(CLOSED.get_moves(5, CLOSED.size() - 1, moves));
+
+  // the last chunk stays in memory
+  ASSERT_TRUE(CLOSED.unpack(CLOSED.size() - 1, C));
+  ASSERT_EQ(C[0], G.V[G.size() - 1]);
+}
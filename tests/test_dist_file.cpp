@@ -0,0 +1,82 @@
+#include <cstring>
+#include <fstream>
+#include <lacam.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(DistFile, save_and_load)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 3);
+  const auto filename = testing::TempDir() + "random-32-32-10.dist";
+  ASSERT_TRUE(write_dist_file(filename, ins.G, ins.goals));
+
+  auto file = std::make_shared<const DistFile>(filename);
+  ASSERT_TRUE(file->is_valid());
+  ASSERT_EQ(file->header->num_goals, 3);
+  ASSERT_EQ(file->get(ins.G.hash + 1, ins.goals[0]->id), nullptr);
+  ASSERT_EQ(file->get(ins.G.hash, ins.starts[0]->id), nullptr);
+  ASSERT_EQ(file->header->dist_bytes, 2);
+  auto field = (const uint16_t*)file->get(ins.G.hash, ins.goals[0]->id);
+  ASSERT_NE(field, nullptr);
+  ASSERT_EQ(field[ins.starts[0]->id], 16);
+
+  // used by DistTable through the cache, without BFS
+  auto& cache = DistCache::get_instance();
+  cache.clear();
+  cache.attach(file);
+  auto D = DistTable(ins, false);
+  ASSERT_EQ(cache.hit, 3);
+  ASSERT_EQ(cache.miss, 0);
+  ASSERT_EQ(D.get(0, ins.starts[0]), 16);
+  cache.clear();
+
+  ASSERT_FALSE(DistFile(map_filename).is_valid());
+}
+
+TEST(DistFile, wide)
+{
+  // more than 0xffff vertices, fields are 32-bit
+  const auto map_filename = testing::TempDir() + "empty-300-300.map";
+  GridMap(300, 300).save(map_filename);
+  const auto ins = Instance(map_filename, std::vector<int>({0, 299}),
+                            std::vector<int>({300 * 300 - 1, 0}));
+  const auto filename = testing::TempDir() + "empty-300-300.dist";
+  ASSERT_TRUE(write_dist_file(filename, ins.G, ins.goals));
+
+  auto file = std::make_shared<const DistFile>(filename);
+  ASSERT_TRUE(file->is_valid());
+  ASSERT_EQ(file->header->dist_bytes, 4);
+  auto field = (const uint32_t*)file->get(ins.G.hash, ins.goals[0]->id);
+  ASSERT_NE(field, nullptr);
+  ASSERT_EQ(field[ins.starts[0]->id], 598);
+
+  auto& cache = DistCache::get_instance();
+  cache.clear();
+  cache.attach(file);
+  auto D = DistTable(ins, false);
+  ASSERT_EQ(cache.hit, 2);
+  ASSERT_EQ(cache.miss, 0);
+  ASSERT_EQ(D.get(0, ins.starts[0]), 598);
+  ASSERT_EQ(D.get(1, ins.starts[1]), 299);
+  cache.clear();
+}
+
+TEST(DistFile, corrupt_header)
+{
+  // n * K * dist_bytes wraps around to zero, nothing but the header is left
+  auto header = DistFileHeader();
+  std::memcpy(header.magic, DistFile::MAGIC, sizeof(header.magic));
+  header.version = DistFile::VERSION;
+  header.num_vertices = 0xffffffff;
+  header.map_hash = 0;
+  header.num_goals = 1 << 30;
+  header.dist_bytes = 4;
+  const auto filename = testing::TempDir() + "corrupt.dist";
+  {
+    std::ofstream file(filename, std::ios::binary);
+    file.write((const char*)&header, sizeof(header));
+  }
+  ASSERT_FALSE(DistFile(filename).is_valid());
+}
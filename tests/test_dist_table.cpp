@@ -12,3 +12,89 @@ TEST(dist_table, init)
   ASSERT_EQ(dist_table.get(0, ins.goals[0]), 0);
   ASSERT_EQ(dist_table.get(0, ins.starts[0]), 16);
 }
+
+TEST(dist_table, eager)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 10);
+  auto lazy = DistTable(ins, false);
+  auto eager = DistTable(ins, true);
+  ASSERT_TRUE(eager.eager);
+
+  for (size_t i = 0; i < ins.N; ++i) {
+    for (auto v : ins.G.V) ASSERT_EQ(eager.get(i, v), lazy.get(i, v));
+  }
+
+  // agents sharing a goal share a row
+  const auto ins_shared = Instance(map_filename, std::vector<int>({0, 1}),
+                                   std::vector<int>({5, 5}));
+  auto D = DistTable(ins_shared, true);
+  ASSERT_EQ(D.dists.size(), ins_shared.G.size());
+  ASSERT_EQ(D.get(0, ins_shared.G.U[5]), 0);
+  ASSERT_EQ(D.get(1, ins_shared.G.U[0]), 5);
+}
+
+TEST(dist_table, cache)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins1 = Instance(scen_filename, map_filename, 3);
+  const auto ins2 = Instance(scen_filename, map_filename, 2);
+  auto& cache = DistCache::get_instance();
+  cache.clear();
+  cache.set_budget(1 << 20);
+
+  // fields are shared across instances on the same map
+  auto D1 = DistTable(ins1, false);
+  ASSERT_TRUE(D1.eager);
+  ASSERT_EQ(cache.miss, 3);
+  auto D2 = DistTable(ins2, false);
+  ASSERT_EQ(cache.hit, 2);
+  ASSERT_EQ(D1.rows[0], D2.rows[0]);
+  ASSERT_EQ(D2.get(0, ins2.starts[0]), 16);
+  ASSERT_EQ(get_sum_of_costs_lower_bound(ins2, D1),
+            get_sum_of_costs_lower_bound(ins2, D2));
+
+  // LRU eviction
+  const size_t field_bytes = ins1.G.size() * sizeof(uint16_t);
+  cache.set_budget(field_bytes * 2);
+  ASSERT_EQ(cache.fields.size(), 2);
+  ASSERT_EQ(D1.get(0, ins1.goals[0]), 0);  // still valid
+
+  cache.set_budget(0);
+  cache.clear();
+}
+
+TEST(dist_table, set_goal)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 3);
+  const auto ins_ref = Instance(scen_filename, map_filename, 4);
+  auto ref = DistTable(ins_ref, false);
+  for (auto eager : {false, true}) {
+    auto D = DistTable(ins, eager);
+    const auto d_other = D.get(1, ins.starts[1]);
+    D.set_goal(0, ins_ref.goals[3]);
+    for (auto v : ins.G.V) ASSERT_EQ(D.get(0, v), ref.get(3, v));
+    ASSERT_EQ(D.get(1, ins.starts[1]), d_other);
+  }
+}
+
+TEST(dist_table, wide)
+{
+  // more than 0xffff vertices, rows are 32-bit
+  const auto map_filename = testing::TempDir() + "empty-300-300.map";
+  GridMap(300, 300).save(map_filename);
+  const auto ins = Instance(map_filename, std::vector<int>({0, 299}),
+                            std::vector<int>({300 * 300 - 1, 0}));
+  auto lazy = DistTable(ins, false);
+  auto eager = DistTable(ins, true);
+  ASSERT_TRUE(eager.eager);
+  ASSERT_TRUE(eager.wide);
+  ASSERT_EQ(eager.get(0, ins.starts[0]), 598);
+  ASSERT_EQ(lazy.get(0, ins.starts[0]), 598);
+  ASSERT_EQ(eager.get(1, ins.starts[1]), 299);
+  ASSERT_EQ(lazy.get(1, ins.starts[1]), 299);
+}
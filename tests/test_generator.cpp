@@ -0,0 +1,56 @@
+#include <lacam.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(Generator, maps)
+{
+  auto MT = std::mt19937(0);
+  const auto filename = testing::TempDir() + "generated.map";
+  for (auto type = 0; type < 4; ++type) {
+    const auto map = type == 0   ? make_random_map(64, 48, 0.2, &MT)
+                     : type == 1 ? make_warehouse_map(64, 48)
+                     : type == 2 ? make_maze_map(64, 48, 2, 0.1, &MT)
+                                 : make_room_map(64, 48, 8, &MT);
+    ASSERT_EQ(map.cells.size(), 64 * 48);
+    ASSERT_GT(map.count_free(), 0);
+
+    // connected, all free cells are reachable from one
+    auto connected = map;
+    connected.keep_largest_component();
+    ASSERT_EQ(connected.cells, map.cells);
+
+    ASSERT_TRUE(map.save(filename));
+    const auto G = Graph(filename);
+    ASSERT_EQ(G.width, 64);
+    ASSERT_EQ(G.height, 48);
+    ASSERT_EQ(G.size(), map.count_free());
+  }
+}
+
+TEST(Generator, scen)
+{
+  auto MT = std::mt19937(0);
+  const auto map_filename = testing::TempDir() + "room-32-32-8.map";
+  const auto scen_filename = testing::TempDir() + "room-32-32-8.scen";
+  ASSERT_TRUE(make_room_map(32, 32, 8, &MT).save(map_filename));
+
+  // all free cells, starts are distinct
+  const auto K = Graph(map_filename).size();
+  const auto ins = Instance(map_filename, &MT, K);
+  ASSERT_TRUE(ins.is_valid());
+  std::vector<bool> used(K, false);
+  for (auto v : ins.starts) {
+    ASSERT_FALSE(used[v->id]);
+    used[v->id] = true;
+  }
+  ASSERT_FALSE(Instance(map_filename, &MT, K + 1).is_valid());
+
+  // reloaded as a scenario of MAPF benchmarks
+  const auto ins_small = Instance(map_filename, &MT, 20);
+  ASSERT_TRUE(save_scen(scen_filename, map_filename, ins_small));
+  const auto loaded = Instance(scen_filename, map_filename, 20);
+  ASSERT_TRUE(loaded.is_valid());
+  ASSERT_TRUE(is_same_config(loaded.starts, ins_small.starts));
+  ASSERT_TRUE(is_same_config(loaded.goals, ins_small.goals));
+  ASSERT_FALSE(solve(loaded).empty());
+}
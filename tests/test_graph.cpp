@@ -13,3 +13,71 @@ TEST(Graph, load_graph)
   ASSERT_EQ(G.width, 32);
   ASSERT_EQ(G.height, 32);
 }
+
+TEST(Graph, config_hasher)
+{
+  const std::string filename = "./assets/random-32-32-10.map";
+  auto G = Graph(filename);
+  auto hasher = ConfigHasher();
+
+  auto C = Config({G.V[0], G.V[1], G.V[28]});
+  auto hash = hasher(C);
+  ASSERT_NE(hash, hasher(Config({G.V[1], G.V[0], G.V[28]})));
+
+  // incremental update matches full recomputation
+  hash = ConfigHasher::update(hash, 0, C[0], G.V[2]);
+  C[0] = G.V[2];
+  hash = ConfigHasher::update(hash, 2, C[2], G.V[29]);
+  C[2] = G.V[29];
+  ASSERT_EQ(hash, hasher(C));
+}
+
+TEST(Graph, config_ids)
+{
+  const std::string filename = "./assets/random-32-32-10.map";
+  auto G = Graph(filename);
+
+  auto C = Config(3, nullptr);
+  ASSERT_EQ(C[1], nullptr);
+  C[0] = G.V[5];
+  C[1] = G.V[0];
+  C[2] = C[0];
+  ASSERT_EQ(C.ids[0], 5);
+  ASSERT_EQ(C.ids[1], 0);
+  ASSERT_EQ(C[2], G.V[5]);
+  ASSERT_EQ(C[1]->id, 0);
+  C[1] = nullptr;
+  ASSERT_EQ(C.ids[1], Config::NONE);
+
+  // conversion from/to vectors of vertices
+  const Vertices V = {G.V[3], G.V[4]};
+  ASSERT_EQ(Vertices(Config(V)), V);
+  ASSERT_EQ(Config(V), Config({G.V[3], G.V[4]}));
+}
+
+TEST(Graph, csr)
+{
+  const std::string filename = "./assets/random-32-32-10.map";
+  auto G = Graph(filename);
+  ASSERT_EQ(G.adj_offsets.size(), G.size() + 1);
+  for (auto v : G.V) {
+    const auto k = G.adj_offsets[v->id];
+    ASSERT_EQ(G.adj_offsets[v->id + 1] - k, v->neighbor.size());
+    for (size_t j = 0; j < v->neighbor.size(); ++j) {
+      ASSERT_EQ(G.adj[k + j], v->neighbor[j]->id);
+    }
+  }
+}
+
+TEST(Graph, load_crlf)
+{
+  const auto filename = testing::TempDir() + "crlf.map";
+  std::ofstream(filename) << "type octile\r\nheight 2\r\nwidth 3\r\nmap\r\n"
+                          << ".@.\r\n...\r\n";
+  auto G = Graph(filename);
+  ASSERT_EQ(G.width, 3);
+  ASSERT_EQ(G.height, 2);
+  ASSERT_EQ(G.size(), 5);
+  ASSERT_EQ(G.U[1], nullptr);
+  ASSERT_EQ(G.U[5]->neighbor.size(), 2);
+}
@@ -13,3 +13,18 @@ TEST(Instance, initialize)
   ASSERT_EQ(ins.starts[0]->index, 203);
   ASSERT_EQ(ins.goals[0]->index, 583);
 }
+
+TEST(Instance, shared_graph)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  auto G = std::make_shared<const Graph>(map_filename);
+  auto MT = std::mt19937(0);
+  const auto ins1 = Instance(scen_filename, G, 3);
+  const auto ins2 = Instance(G, &MT, 5);
+
+  ASSERT_EQ(&ins1.G, G.get());
+  ASSERT_EQ(&ins2.G, G.get());
+  ASSERT_EQ(ins1.starts[0]->index, 203);
+  ASSERT_TRUE(ins2.is_valid());
+}
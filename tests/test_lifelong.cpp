@@ -0,0 +1,57 @@
+#include <lacam.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(lifelong, plan)
+{
+  const auto map_filename = "./assets/random-32-32-10.map";
+  auto MT = std::mt19937(0);
+  const auto ins = Instance(map_filename, &MT, 50);
+  auto planner = LifelongPlanner(ins, &MT);
+  const auto& G = ins.G;
+
+  int reached = 0;
+  auto C_prev = planner.get_config();
+  for (auto t = 0; t < 100; ++t) {
+    const auto configs = planner.plan(2);
+    ASSERT_EQ(configs.size(), 2);
+    for (auto& C : configs) {
+      // no vertex and swap collisions, moves along edges
+      for (size_t i = 0; i < ins.N; ++i) {
+        auto& nbr = C_prev[i]->neighbor;
+        ASSERT_TRUE(C[i] == C_prev[i] ||
+                    std::find(nbr.begin(), nbr.end(), C[i]) != nbr.end());
+        for (size_t j = i + 1; j < ins.N; ++j) {
+          ASSERT_NE(C[i], C[j]);
+          ASSERT_FALSE(C[i] == C_prev[j] && C[j] == C_prev[i]);
+        }
+      }
+      C_prev = C;
+    }
+    ASSERT_TRUE(is_same_config(C_prev, planner.get_config()));
+
+    // new goals for agents at their goals
+    for (size_t i = 0; i < ins.N; ++i) {
+      if (C_prev[i] != planner.ins.goals[i]) continue;
+      ++reached;
+      planner.set_goal(i, G.V[MT() % G.V.size()]);
+    }
+  }
+  ASSERT_GT(reached, 0);
+}
+
+TEST(lifelong, step)
+{
+  const auto map_filename = "./assets/random-32-32-10.map";
+  auto MT = std::mt19937(0);
+  const auto ins = Instance(map_filename, &MT, 50);
+  auto planner_plan = LifelongPlanner(ins);
+  auto planner_step = LifelongPlanner(ins);
+
+  const auto configs = planner_plan.plan(3);
+  auto C = ins.starts;
+  for (auto& C_plan : configs) {
+    C = planner_step.step(C, ins.goals);
+    ASSERT_TRUE(is_same_config(C, C_plan));
+  }
+}
@@ -8,8 +8,14 @@ TEST(planner, solve)
   const auto map_filename = "./assets/random-32-32-10.map";
   const auto ins = Instance(scen_filename, map_filename, 3);
 
-  auto solution = solve(ins);
+  Metrics metrics;
+  auto solution = solve(ins, 0, nullptr, nullptr, &metrics);
   ASSERT_TRUE(is_feasible_solution(ins, solution));
+
+  // tracked in backtracking
+  const auto expected = get_metrics(solution);
+  ASSERT_EQ(metrics.path_costs, expected.path_costs);
+  ASSERT_EQ(metrics.sum_of_loss, expected.sum_of_loss);
 }
 
 TEST(planner, unsolvable_instance)
@@ -21,3 +27,169 @@ TEST(planner, unsolvable_instance)
   auto solution = solve(ins);
   ASSERT_TRUE(solution.empty());
 }
+
+TEST(planner, portfolio)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 50);
+  auto solution = solve_portfolio(ins, 4);
+  ASSERT_FALSE(solution.empty());
+  ASSERT_TRUE(is_feasible_solution(ins, solution));
+
+  const auto ins_unsolvable =
+      Instance("./tests/assets/2x1.scen", "./tests/assets/2x1.map", 2);
+  ASSERT_TRUE(solve_portfolio(ins_unsolvable, 2).empty());
+}
+
+TEST(planner, parallel)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 50);
+  for (auto threads : {1, 4}) {
+    auto solution = solve_parallel(ins, threads);
+    ASSERT_FALSE(solution.empty());
+    ASSERT_TRUE(is_feasible_solution(ins, solution));
+  }
+
+  const auto ins_unsolvable =
+      Instance("./tests/assets/2x1.scen", "./tests/assets/2x1.map", 2);
+  ASSERT_TRUE(solve_parallel(ins_unsolvable, 4).empty());
+}
+
+TEST(planner, anytime)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 50);
+  const auto solution_init = solve(ins);
+
+  Planner::FLG_ANYTIME = true;
+  const auto deadline = Deadline(500);
+  const auto solution = solve(ins, 0, &deadline);
+  Planner::FLG_ANYTIME = false;
+  ASSERT_TRUE(is_feasible_solution(ins, solution));
+  ASSERT_LE(get_sum_of_loss(solution), get_sum_of_loss(solution_init));
+}
+
+TEST(planner, anytime_improvement)
+{
+  // the initial solution is found by the same search, then refined
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 20);
+  auto MT = std::mt19937(0);
+  const auto solution_init = solve(ins, 0, nullptr, &MT);
+
+  Planner::FLG_ANYTIME = true;
+  const auto deadline = Deadline(200);
+  MT.seed(0);
+  const auto solution = solve(ins, 0, &deadline, &MT);
+  Planner::FLG_ANYTIME = false;
+  ASSERT_TRUE(is_feasible_solution(ins, solution));
+  ASSERT_LT(get_sum_of_loss(solution), get_sum_of_loss(solution_init));
+}
+
+TEST(planner, parallel_with_anytime_flag)
+{
+  // anytime refinement is for solve only, solve_parallel ignores it
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 50);
+  Planner::FLG_ANYTIME = true;
+  const auto deadline = Deadline(2000);
+  const auto solution = solve_parallel(ins, 2, 0, &deadline);
+  Planner::FLG_ANYTIME = false;
+  ASSERT_FALSE(solution.empty());
+  ASSERT_TRUE(is_feasible_solution(ins, solution));
+}
+
+TEST(planner, memory_budget)
+{
+  const auto map_filename = "./assets/random-32-32-10.map";
+  auto MT = std::mt19937(0);
+  const auto ins = Instance(map_filename, &MT, 300);
+  auto MT_solve = std::mt19937(0);
+  const auto solution = solve(ins, 0, nullptr, &MT_solve);
+
+  Planner::MEMORY_BUDGET = 1;  // evict and spill as much as possible
+  MT_solve.seed(0);
+  const auto solution_budget = solve(ins, 0, nullptr, &MT_solve);
+  Planner::MEMORY_BUDGET = 0;
+  ASSERT_TRUE(is_feasible_solution(ins, solution_budget));
+  ASSERT_EQ(solution_budget.size(), solution.size());
+  for (size_t t = 0; t < solution.size(); ++t) {
+    ASSERT_TRUE(is_same_config(solution[t], solution_budget[t]));
+  }
+}
+
+TEST(planner, sort_order)
+{
+  // radix sort for N >= 64, otherwise std::stable_sort
+  auto MT = std::mt19937(0);
+  std::vector<uint32_t> keys, keys_buf;
+  std::vector<int> order, order_buf;
+  for (auto N : {10, 1000}) {
+    std::vector<float> priorities(N);
+    for (auto& p : priorities) {
+      // ties and zeros, as in dynamic priorities
+      p = (int)(get_random_float(&MT) * 8) + (get_random_float(&MT) < 0.5
+                                                  ? 0.0f
+                                                  : get_random_float(&MT));
+    }
+    priorities[0] = 0;
+    sort_order(priorities, order, keys, keys_buf, order_buf);
+
+    std::vector<int> expected(N);
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(), expected.end(), [&](int i, int j) {
+      return priorities[i] > priorities[j];
+    });
+    ASSERT_EQ(order, expected);
+  }
+}
+
+TEST(planner, restore_priorities)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 100);
+  auto planner = Planner(&ins, nullptr, nullptr);
+  planner.CLOSED = std::make_unique<ConfigTable>(&ins.G, ins.N);
+
+  // path of nodes, start -> one step -> goals
+  std::vector<int> order(ins.N);
+  std::iota(order.begin(), order.end(), 0);
+  Constraint M;
+  ASSERT_TRUE(planner.get_new_config(ins.starts, order, &M));
+  auto C1 = ins.starts;
+  for (auto a : planner.A) C1[a->id] = a->v_next;
+  Node S0(planner.CLOSED->insert(ins.starts).first);
+  Node S1(planner.CLOSED->insert(C1).first, &S0);
+  Node S2(planner.CLOSED->insert(ins.goals).first, &S1);
+  planner.setup_node(&S0, ins.starts);
+  planner.setup_node(&S1, C1);
+  planner.setup_node(&S2, ins.goals);
+  const auto p1 = S1.priorities;
+  const auto p2 = S2.priorities;
+
+  // replay from the nearest ancestor with priorities
+  S1.evict();
+  S2.evict();
+  planner.restore_priorities(&S2);
+  ASSERT_EQ(S2.priorities, p2);
+  ASSERT_TRUE(S1.priorities.empty());
+
+  // replay from the start
+  S0.evict();
+  S2.evict();
+  planner.restore_priorities(&S2);
+  ASSERT_EQ(S2.priorities, p2);
+
+  // setup_node restores the priorities of an evicted parent
+  ASSERT_TRUE(S1.priorities.empty());
+  planner.setup_node(&S2, ins.goals);
+  ASSERT_EQ(S1.priorities, p1);
+  ASSERT_EQ(S2.priorities, p2);
+}
@@ -63,4 +63,139 @@ TEST(PostProcessing, metrics)
 
   ASSERT_EQ(get_makespan(sol), 2);
   ASSERT_EQ(get_sum_of_costs(sol), 4);
+  ASSERT_EQ(get_sum_of_loss(sol), 4);
+
+  // agent-0 leaves its goal and comes back
+  sol.push_back(Config({ins.G.U[3], ins.G.U[4], ins.G.U[11]}));
+  sol.push_back(Config({ins.G.U[2], ins.G.U[4], ins.G.U[11]}));
+  auto metrics = get_metrics(sol);
+  ASSERT_EQ(metrics.makespan, 4);
+  ASSERT_EQ(metrics.path_costs, std::vector<int>({4, 1, 1}));
+  ASSERT_EQ(metrics.sum_of_costs, 6);
+  ASSERT_EQ(metrics.sum_of_loss, 6);
+
+  // incremental, as the solution grows
+  auto tracker = MetricsTracker(ins.goals);
+  auto sol_inc = Solution();
+  for (auto& C : sol) {
+    sol_inc.push_back(C);
+    tracker.update(sol_inc);
+  }
+  auto metrics_inc = tracker.get();
+  ASSERT_EQ(metrics_inc.makespan, metrics.makespan);
+  ASSERT_EQ(metrics_inc.path_costs, metrics.path_costs);
+  ASSERT_EQ(metrics_inc.sum_of_costs, metrics.sum_of_costs);
+  ASSERT_EQ(metrics_inc.sum_of_loss, metrics.sum_of_loss);
+}
+
+TEST(PostProcessing, metrics_in_parallel)
+{
+  // random walks, long enough for several chunks of timesteps
+  const auto map_filename = "./assets/random-32-32-10.map";
+  auto G = Graph(map_filename);
+  auto MT = std::mt19937(0);
+  const int N = 200;
+  const int T = 2000;
+  auto C = Config(N, nullptr);
+  for (auto i = 0; i < N; ++i) C.set(i, G.V[i]);
+  auto solution = Solution();
+  for (auto t = 0; t < T; ++t) {
+    for (auto i = 0; i < N; ++i) {
+      if (get_random_float(&MT) < 0.7) continue;  // often waiting
+      auto& nbr = C[i]->neighbor;
+      C.set(i, nbr[get_random_int(&MT, 0, nbr.size() - 1)]);
+    }
+    solution.push_back(C);
+  }
+  const auto expected = get_metrics(solution, 1);
+  for (auto threads : {0, 4}) {
+    const auto metrics = get_metrics(solution, threads);
+    ASSERT_EQ(metrics.makespan, expected.makespan);
+    ASSERT_EQ(metrics.path_costs, expected.path_costs);
+    ASSERT_EQ(metrics.sum_of_costs, expected.sum_of_costs);
+    ASSERT_EQ(metrics.sum_of_loss, expected.sum_of_loss);
+  }
+  ASSERT_LT(expected.sum_of_loss, expected.sum_of_costs);
+}
+
+TEST(PostProcessing, violation)
+{
+  const auto map_filename = "./assets/empty-8-8.map";
+  const auto start_indexes = std::vector<int>({0, 8, 16});
+  const auto goal_indexes = std::vector<int>({9, 1, 17});
+  const auto ins = Instance(map_filename, start_indexes, goal_indexes);
+  auto& U = ins.G.U;
+
+  auto sol = Solution(3);
+  sol[0] = Config({U[0], U[8], U[16]});
+  sol[1] = Config({U[1], U[0], U[16]});
+  sol[2] = Config({U[9], U[1], U[17]});
+  ASSERT_EQ(validate_solution(ins, sol).kind, Violation::NONE);
+
+  sol[0] = Config({U[0], U[8], U[24]});
+  auto res = validate_solution(ins, sol);
+  ASSERT_EQ(res.kind, Violation::INVALID_START);
+  ASSERT_EQ(res.agent, 2);
+  ASSERT_EQ(res.time, 0);
+
+  // swap at t=1, vertex conflict at t=2, reported in order of time
+  sol[0] = Config({U[0], U[8], U[16]});
+  sol[1] = Config({U[8], U[0], U[16]});
+  sol[2] = Config({U[9], U[9], U[17]});
+  sol.push_back(Config({U[9], U[1], U[17]}));
+  res = validate_solution(ins, sol);
+  ASSERT_EQ(res.kind, Violation::SWAP_CONFLICT);
+  ASSERT_EQ(res.agent, 0);
+  ASSERT_EQ(res.time, 1);
+
+  sol[1] = Config({U[1], U[0], U[16]});
+  res = validate_solution(ins, sol);
+  ASSERT_EQ(res.kind, Violation::VERTEX_CONFLICT);
+  ASSERT_EQ(res.agent, 0);
+  ASSERT_EQ(res.time, 2);
+
+  // agent-2 jumps over a vertex
+  sol[2] = Config({U[9], U[1], U[26]});
+  res = validate_solution(ins, sol);
+  ASSERT_EQ(res.kind, Violation::INVALID_MOVE);
+  ASSERT_EQ(res.agent, 2);
+  ASSERT_EQ(res.time, 2);
+}
+
+TEST(PostProcessing, violation_in_later_chunk)
+{
+  // agents oscillate between the first two columns, i.e., x = t % 2
+  // N = 1000 and T = 401 give chunks of 66 timesteps
+  const int N = 1000;
+  const int T = 401;
+  const auto map_filename = testing::TempDir() + "empty-3-1000.map";
+  GridMap(3, N).save(map_filename);
+  std::vector<int> indexes;
+  for (auto i = 0; i < N; ++i) indexes.push_back(i * 3);
+  const auto ins = Instance(map_filename, indexes, indexes);
+  auto& U = ins.G.U;
+
+  // agent-j jumps from x = 0 to x = 2 at t
+  auto get_solution = [&](std::vector<std::pair<int, int> > jumps) {
+    auto sol = Solution();
+    auto C = Config(N, nullptr);
+    for (auto t = 0; t < T; ++t) {
+      for (auto i = 0; i < N; ++i) C.set(i, U[i * 3 + t % 2]);
+      for (auto& [j, t_jump] : jumps) {
+        if (t == t_jump) C.set(j, U[j * 3 + 2]);
+      }
+      sol.push_back(C);
+    }
+    return sol;
+  };
+  for (auto threads : {1, 4}) {
+    ASSERT_EQ(validate_solution(ins, get_solution({}), threads).kind,
+              Violation::NONE);
+    // the earliest one, not the one in the last chunk
+    const auto res =
+        validate_solution(ins, get_solution({{5, 391}, {700, 301}}), threads);
+    ASSERT_EQ(res.kind, Violation::INVALID_MOVE);
+    ASSERT_EQ(res.agent, 700);
+    ASSERT_EQ(res.time, 301);
+  }
 }
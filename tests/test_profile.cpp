@@ -0,0 +1,35 @@
+#include <lacam.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(Profile, counters)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 50);
+
+  Profile::reset();
+  auto solution = solve(ins);
+  ASSERT_FALSE(solution.empty());
+  auto p = Profile::get();
+#ifdef LACAM_PROFILE
+  ASSERT_GT(p.counts[Profile::EXPANSIONS], 0);
+  ASSERT_EQ(p.counts[Profile::CONSTRAINTS],
+            p.counts[Profile::CLOSED_HITS] + p.counts[Profile::CLOSED_MISSES] +
+                p.counts[Profile::FAIL_VERTEX] + p.counts[Profile::FAIL_SWAP] +
+                p.counts[Profile::FAIL_PIBT]);
+  ASSERT_GE(p.counts[Profile::PIBT_MAX_DEPTH], 1);
+  ASSERT_GT(p.counts[Profile::BFS_EXPANSIONS], 0);
+  ASSERT_GT(p.counts[Profile::ALLOC_BYTES], 0);
+
+  // counters of finished threads are kept
+  Profile::reset();
+  solution = solve_parallel(ins, 2);
+  ASSERT_FALSE(solution.empty());
+  ASSERT_GT(Profile::get().counts[Profile::EXPANSIONS], 0);
+#else
+  // compiled out
+  for (auto c : p.counts) ASSERT_EQ(c, 0);
+#endif
+  ASSERT_EQ(Profile::to_json().front(), '{');
+}
@@ -0,0 +1,88 @@
+#include <lacam.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(Solution, moves)
+{
+  const std::string filename = "./assets/empty-8-8.map";
+  auto G = Graph(filename);
+  auto& U = G.U;
+
+  // agent-0 moves right, agent-1 waits
+  std::vector<Config> configs;
+  for (auto t = 0; t < 200; ++t) {
+    configs.push_back(Config({U[t % 8], U[63]}));
+  }
+  const auto solution = Solution(configs);
+  ASSERT_EQ(solution.size(), configs.size());
+  ASSERT_EQ(solution.num_moves, configs.size() - 1);
+  ASSERT_EQ(solution.back(), configs.back());
+  ASSERT_EQ(solution.front(), configs.front());
+
+  // random access, across keyframes
+  for (auto t : {0, 1, 63, 64, 65, 128, 199}) {
+    ASSERT_EQ(solution[t], configs[t]);
+    ASSERT_EQ(solution.get(t, 0), configs[t][0]);
+    ASSERT_EQ(solution.get(t, 1), U[63]);
+  }
+
+  // iteration
+  size_t t = 0;
+  for (auto& C : solution) ASSERT_EQ(C, configs[t++]);
+  ASSERT_EQ(t, configs.size());
+}
+
+TEST(Solution, set)
+{
+  const std::string filename = "./assets/empty-8-8.map";
+  auto G = Graph(filename);
+  auto& U = G.U;
+
+  // agents are taken from the first assignment
+  auto solution = Solution(3);
+  solution[1] = Config({U[1], U[2]});
+  ASSERT_EQ(solution.N, 2);
+  ASSERT_EQ(solution[0], Config({U[1], U[2]}));
+  ASSERT_EQ(solution.num_moves, 0);
+
+  solution[0] = Config({U[0], U[2]});
+  solution[2] = Config({U[9], U[3]});
+  ASSERT_EQ(solution.num_moves, 3);
+  ASSERT_EQ(solution[0], Config({U[0], U[2]}));
+  ASSERT_EQ(solution[1], Config({U[1], U[2]}));
+  ASSERT_EQ(solution.back(), Config({U[9], U[3]}));
+
+  // rewrite the middle, moves of t and t+1 are replaced
+  solution[1] = Config({U[0], U[3]});
+  ASSERT_EQ(solution.num_moves, 2);
+  ASSERT_EQ(solution[1][0], U[0]);
+  ASSERT_EQ(solution[2][1], U[3]);
+  solution.push_back(Config({U[9], U[3]}));
+  ASSERT_EQ(solution.size(), 4);
+  ASSERT_EQ(solution.num_moves, 2);
+}
+
+TEST(Solution, packed_moves)
+{
+  const std::string filename = "./assets/random-32-32-10.map";
+  auto G = Graph(filename);
+  auto MT = std::mt19937(0);
+
+  // moves cross word boundaries, 13 bits each
+  std::vector<Config> configs;
+  for (auto t = 0; t < 300; ++t) {
+    auto C = Config(5, nullptr);
+    for (auto i = 0; i < 5; ++i) {
+      C.set(i, G.V[get_random_int(&MT, 0, G.size() - 1)]);
+    }
+    if (t == 100) C.set(2, nullptr);  // unassigned is a move as well
+    configs.push_back(C);
+  }
+  const auto solution = Solution(configs);
+  ASSERT_EQ(solution.move_bits, 3 + 10);
+  ASSERT_LT(solution.packed.size() * 8, solution.num_moves * 2);
+  size_t t = 0;
+  for (auto& C : solution) ASSERT_EQ(C, configs[t++]);
+  ASSERT_EQ(solution.get(100, 2), nullptr);
+  ASSERT_EQ(solution.get(101, 2), configs[101][2]);
+}
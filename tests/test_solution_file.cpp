@@ -0,0 +1,119 @@
+#include <lacam.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(SolutionFile, save_and_load)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 50);
+  const auto solution = solve(ins);
+  ASSERT_FALSE(solution.empty());
+  const auto metrics = get_metrics(solution);
+  const auto meta = get_log_meta(ins, solution, metrics, 0, map_filename, 0);
+  const auto log = SolutionLog(ins, solution, meta);
+  ASSERT_TRUE(log.solution.empty());  // streamed from solution
+  ASSERT_EQ(log.size(), solution.size());
+  std::vector<std::vector<int> > expected;
+  for (auto& C : solution) {
+    expected.emplace_back();
+    for (auto v : C) expected.back().push_back(v->index);
+  }
+
+  for (auto rle : {false, true}) {
+    const auto filename = testing::TempDir() + "solution.bin";
+    ASSERT_TRUE(write_solution_file(filename, log, rle));
+    const auto loaded = read_solution_file(filename);
+    ASSERT_TRUE(loaded.is_valid());
+    ASSERT_EQ(loaded.width, 32);
+    ASSERT_EQ(loaded.meta, meta);
+    ASSERT_EQ(loaded.starts, log.starts);
+    ASSERT_EQ(loaded.goals, log.goals);
+    ASSERT_EQ(loaded.solution, expected);
+  }
+
+  // same text as make_log
+  const auto text_filename = testing::TempDir() + "solution.txt";
+  const auto log_filename = testing::TempDir() + "solution_log.txt";
+  make_log(ins, solution, metrics, log_filename, 0, map_filename, 0);
+  ASSERT_TRUE(write_text_log(text_filename, log));
+  auto read = [](const std::string& filename) {
+    std::ifstream file(filename);
+    std::string res, line;
+    while (std::getline(file, line)) {
+      if (line.rfind("profile=", 0) != 0) res += line + "\n";  // varies
+    }
+    return res;
+  };
+  ASSERT_EQ(read(text_filename), read(log_filename));
+  // from a loaded log, as in the conversion of main
+  const auto bin_filename = testing::TempDir() + "solution.bin";
+  ASSERT_TRUE(write_text_log(text_filename, read_solution_file(bin_filename)));
+  ASSERT_EQ(read(text_filename), read(log_filename));
+
+  ASSERT_FALSE(read_solution_file(map_filename).is_valid());
+}
+
+TEST(SolutionFile, empty_solution)
+{
+  // e.g., when failed, no configuration nor graph in the solution
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 10);
+  const auto solution = Solution();
+  const auto log = SolutionLog(ins, solution, "");
+  ASSERT_EQ(log.size(), 0);
+
+  for (auto rle : {false, true}) {
+    const auto filename = testing::TempDir() + "empty.bin";
+    ASSERT_TRUE(write_solution_file(filename, log, rle));
+    const auto loaded = read_solution_file(filename);
+    ASSERT_TRUE(loaded.is_valid());
+    ASSERT_EQ(loaded.starts, log.starts);
+    ASSERT_TRUE(loaded.solution.empty());
+  }
+  ASSERT_TRUE(write_text_log(testing::TempDir() + "empty.txt", log));
+}
+
+TEST(SolutionFile, corrupted_header)
+{
+  const auto scen_filename = "./assets/random-32-32-10-random-1.scen";
+  const auto map_filename = "./assets/random-32-32-10.map";
+  const auto ins = Instance(scen_filename, map_filename, 10);
+  const auto solution = solve(ins);
+  const auto log = SolutionLog(ins, solution, "");
+  const auto filename = testing::TempDir() + "solution.bin";
+
+  // rewrite the header, then load
+  auto load = [&](bool rle, auto&& edit) {
+    EXPECT_TRUE(write_solution_file(filename, log, rle));
+    std::fstream file(filename, std::ios::in | std::ios::out |
+                                    std::ios::binary);
+    auto header = SolutionFileHeader();
+    file.read((char*)&header, sizeof(header));
+    edit(header);
+    file.seekp(0);
+    file.write((const char*)&header, sizeof(header));
+    file.close();
+    return read_solution_file(filename);
+  };
+  for (auto rle : {false, true}) {
+    ASSERT_TRUE(load(rle, [](SolutionFileHeader&) {}).is_valid());
+    // huge sizes are rejected without allocating them
+    ASSERT_FALSE(load(rle, [](SolutionFileHeader& h) {
+                   h.num_timesteps = 1 << 30;
+                 }).is_valid());
+    ASSERT_FALSE(load(rle, [](SolutionFileHeader& h) {
+                   h.num_agents = 1 << 30;
+                 }).is_valid());
+    ASSERT_FALSE(load(rle, [](SolutionFileHeader& h) {
+                   h.meta_size = UINT64_MAX;
+                 }).is_valid());
+    ASSERT_FALSE(load(rle, [](SolutionFileHeader& h) {
+                   h.body_words = UINT64_MAX / 8;
+                 }).is_valid());
+    ASSERT_FALSE(load(rle, [](SolutionFileHeader& h) {
+                   h.vertex_bits = 33;
+                 }).is_valid());
+  }
+}